@@ -21,8 +21,9 @@
 // digit trie types
 typedef neutx::container::digit_trie<std::string> types;
 
-// trie encoder types
-typedef types::encoder_type<string_codec> encoder;
+// trie encoder types, equal strings are written to the file only once
+typedef types::encoder_type<
+    neutx::container::detail::dedup_codec<string_codec> > encoder;
 
 int main() {
     types::trie_type trie;
@@ -31,6 +32,7 @@ int main() {
     trie.store("123", "three");
     trie.store("1234", "four");
     trie.store("12345", "five");
+    trie.store("4321", "four");
 
     // write (export) trie to the file in external format
     encoder::file_store out("trie.bin");
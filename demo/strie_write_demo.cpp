@@ -25,6 +25,8 @@
 
 #include "string_codec.hpp"
 
+#include <iostream>
+
 namespace ct = neutx::container;
 namespace dt = neutx::container::detail;
 
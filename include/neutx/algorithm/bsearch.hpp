@@ -18,6 +18,12 @@
 #ifndef _NEUTX_ALGORITHM_BSEARCH_HPP_
 #define _NEUTX_ALGORITHM_BSEARCH_HPP_
 
+#include <stdint.h>
+#include <cstddef>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
 namespace neutx {
 namespace algorithm {
 
@@ -62,6 +68,130 @@ inline S *bsearch(S *p, unsigned n, const T& t) {
     }
 }
 
+namespace detail {
+
+// number of leading elements not greater than t
+template<typename T, typename S>
+inline unsigned lcount(const S *p, unsigned n, const T& t) {
+    unsigned c = 0;
+    for (unsigned i = 0; i < n; ++i)
+        c += !(t < p[i]);
+    return c;
+}
+
+#if defined(__AVX2__)
+inline unsigned lcount(const int32_t *p, unsigned n, int32_t t) {
+    __m256i vt = _mm256_set1_epi32(t);
+    unsigned i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(p + i));
+        unsigned m = _mm256_movemask_ps(
+            _mm256_castsi256_ps(_mm256_cmpgt_epi32(v, vt)));
+        if (m)
+            return i + __builtin_ctz(m);
+    }
+    return i + lcount<int32_t, int32_t>(p + i, n - i, t);
+}
+
+inline unsigned lcount(const int64_t *p, unsigned n, int64_t t) {
+    __m256i vt = _mm256_set1_epi64x(t);
+    unsigned i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(p + i));
+        unsigned m = _mm256_movemask_pd(
+            _mm256_castsi256_pd(_mm256_cmpgt_epi64(v, vt)));
+        if (m)
+            return i + __builtin_ctz(m);
+    }
+    return i + lcount<int64_t, int64_t>(p + i, n - i, t);
+}
+#endif
+
+} // namespace detail
+
+// same contract as bsearch() using linear scan: scalar scan counts
+// elements not greater than t without branches on data, AVX2 scan of
+// 32 and 64 bit signed integers stops at the first block holding
+// a greater element; faster than bsearch() for arrays of few cache lines
+template<typename T, typename S>
+inline S *lsearch(S *p, unsigned n, const T& t) {
+    unsigned c = detail::lcount(p, n, t);
+    return c < n ? p + c : 0;
+}
+
+namespace detail {
+
+// first element greater than t in p[lo, n) given p[lo - 1] <= t,
+// galloping from lo
+template<typename T, typename S>
+inline unsigned gallop(S *p, unsigned lo, unsigned n, const T& t) {
+    unsigned step = 1, hi = lo;
+    while (hi < n && !(t < p[hi])) {
+        lo = hi + 1;
+        hi += step;
+        step *= 2;
+    }
+    if (hi > n)
+        hi = n;
+    // first element > t is in [lo, hi]
+    while (lo < hi) {
+        unsigned mid = lo + (hi - lo) / 2;
+        if (t < p[mid])
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    return lo;
+}
+
+} // namespace detail
+
+// bsearch() for m queries at once, out[i] is set to the result for q[i];
+// searches of a group of queries advance together without branches on
+// data, so memory loads of independent searches overlap; sorted queries
+// are searched by galloping forward from the previous result instead
+template<typename T, typename S>
+inline void bsearch(S *p, unsigned n, const T *q, size_t m, S **out) {
+    enum { group = 16 };
+    if (n == 0) {
+        for (size_t i = 0; i < m; ++i)
+            out[i] = 0;
+        return;
+    }
+    bool sorted = true;
+    for (size_t i = 1; sorted && i < m; ++i)
+        sorted = !(q[i] < q[i - 1]);
+    if (sorted) {
+        unsigned k = 0;
+        for (size_t i = 0; i < m; ++i) {
+            k = detail::gallop(p, k, n, q[i]);
+            out[i] = k < n ? p + k : 0;
+        }
+        return;
+    }
+    for (size_t i = 0; i < m; i += group) {
+        unsigned g = m - i < group ? (unsigned)(m - i) : (unsigned)group;
+        S *base[group];
+        for (unsigned j = 0; j < g; ++j)
+            base[j] = p;
+        for (unsigned len = n; len > 1; ) {
+            unsigned half = len / 2;
+            for (unsigned j = 0; j < g; ++j) {
+#if defined(__GNUC__)
+                __builtin_prefetch(base[j] + half / 2);
+                __builtin_prefetch(base[j] + half + half / 2);
+#endif
+                base[j] = q[i + j] < base[j][half] ? base[j] : base[j] + half;
+            }
+            len -= half;
+        }
+        for (unsigned j = 0; j < g; ++j) {
+            S *r = base[j] + !(q[i + j] < *base[j]);
+            out[i + j] = r < p + n ? r : 0;
+        }
+    }
+}
+
 } // namespace algorithm
 } // namespace neutx
 
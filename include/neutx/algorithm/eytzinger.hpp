@@ -0,0 +1,133 @@
+// ex: ts=4 sw=4 ft=cpp et indentexpr=
+/**
+ * \file
+ * \brief sorted array in Eytzinger layout
+ *
+ * Elements of sorted sequence are stored in breadth first order of the
+ * implicit balanced binary search tree, children of node k are nodes 2k
+ * and 2k+1. Search descends without branches on data, and since nodes
+ * of the next four levels below k occupy one or few adjacent cache lines
+ * they are prefetched while the current level is compared. Outperforms
+ * bsearch() on arrays not fitting the CPU cache.
+ *
+ * \author Dmitriy Kargapolov
+ * \since 19 October 2026
+ *
+ */
+
+/*
+ * Copyright (C) 2026 Dmitriy Kargapolov <dmitriy.kargapolov@gmail.com>
+ * Use, modification and distribution are subject to the Boost Software
+ * License, Version 1.0 (See accompanying file LICENSE_1_0.txt or copy
+ * at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef _NEUTX_ALGORITHM_EYTZINGER_HPP_
+#define _NEUTX_ALGORITHM_EYTZINGER_HPP_
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+
+namespace neutx {
+namespace algorithm {
+
+template<typename S>
+class eytzinger_array {
+    // nodes 1..n, node 0 is unused
+    std::vector<S> m_data;
+    size_t m_size;
+
+    // descendants of node k four levels below are nodes 16k..16k+15
+    enum { prefetch_step = 16 };
+
+    template<typename It>
+    void fill(It& it, size_t k) {
+        if (k > m_size)
+            return;
+        fill(it, 2 * k);
+        m_data[k] = *it++;
+        fill(it, 2 * k + 1);
+    }
+
+public:
+    eytzinger_array() : m_size(0) {}
+
+    // build from sorted sequence
+    template<typename It>
+    eytzinger_array(It begin, It end) : m_size(0) { assign(begin, end); }
+
+    template<typename It>
+    void assign(It begin, It end) {
+        std::vector<S> l_sorted(begin, end);
+        m_size = l_sorted.size();
+        m_data.assign(m_size + 1, S());
+        typename std::vector<S>::const_iterator it = l_sorted.begin();
+        fill(it, 1);
+    }
+
+    size_t size() const { return m_size; }
+
+    // first element greater than t or 0, same as bsearch()
+    template<typename T>
+    const S *upper_bound(const T& t) const {
+        const S *p = m_data.data();
+        size_t k = 1;
+        while (k <= m_size) {
+#if defined(__GNUC__)
+            __builtin_prefetch(p + (k * prefetch_step < m_size ?
+                k * prefetch_step : 0));
+#endif
+            k = 2 * k + !(t < p[k]);
+        }
+        // undo right turns and the last left turn
+        k >>= __builtin_ctzll(~(unsigned long long)k) + 1;
+        return k ? p + k : 0;
+    }
+
+    // position of the element in sorted sequence, e.g. to find data
+    // associated with upper_bound() result
+    size_t rank(const S *a_elem) const {
+        size_t k = a_elem - m_data.data();
+        // left subtree of k precedes it, so do parents of right
+        // children on the path to the root with their left subtrees
+        size_t r = subtree_size(2 * k);
+        for (; k > 1; k >>= 1)
+            if (k & 1)
+                r += 1 + subtree_size(k - 1);
+        return r;
+    }
+
+    // i-th element of sorted sequence
+    const S& operator[](size_t i) const { return m_data[node(i)]; }
+
+private:
+    // number of nodes of subtree rooted at k
+    size_t subtree_size(size_t k) const {
+        size_t n = 0;
+        for (size_t w = 1; k <= m_size; k *= 2, w *= 2)
+            n += std::min(w, m_size - k + 1);
+        return n;
+    }
+
+    // node of the i-th element of sorted sequence
+    size_t node(size_t i) const {
+        size_t k = 1;
+        for (;;) {
+            size_t l = subtree_size(2 * k);
+            if (i == l)
+                return k;
+            if (i < l)
+                k = 2 * k;
+            else {
+                i -= l + 1;
+                k = 2 * k + 1;
+            }
+        }
+    }
+};
+
+} // namespace algorithm
+} // namespace neutx
+
+#endif // _NEUTX_ALGORITHM_EYTZINGER_HPP_
@@ -0,0 +1,162 @@
+// ex: ts=4 sw=4 ft=cpp et indentexpr=
+/**
+ * \file
+ * \brief compile-time search tree
+ *
+ * Counterpart of bs<T, S, N> templates for constant tables of any size:
+ * sorted array given at compile time is laid out as perfect binary
+ * search tree in Eytzinger order by constexpr constructor, lookup
+ * descends fixed number of levels unrolled at compile time, each level
+ * being one comparison added to the node index, no branches. Tree is
+ * padded to 2^depth - 1 nodes with the maximum value of the type, so
+ * the leaf reached is the position of the result.
+ *
+ * \author Dmitriy Kargapolov
+ * \since 19 October 2026
+ *
+ */
+
+/*
+ * Copyright (C) 2026 Dmitriy Kargapolov <dmitriy.kargapolov@gmail.com>
+ * Use, modification and distribution are subject to the Boost Software
+ * License, Version 1.0 (See accompanying file LICENSE_1_0.txt or copy
+ * at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef _NEUTX_ALGORITHM_STATIC_SEARCH_HPP_
+#define _NEUTX_ALGORITHM_STATIC_SEARCH_HPP_
+
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+
+namespace neutx {
+namespace algorithm {
+
+namespace detail {
+
+template<size_t... I> struct index_seq {};
+
+template<typename A, typename B> struct seq_cat;
+
+template<size_t... I, size_t... J>
+struct seq_cat<index_seq<I...>, index_seq<J...> > {
+    typedef index_seq<I..., (sizeof...(I) + J)...> type;
+};
+
+// 0..N-1, instantiation depth is log N
+template<size_t N> struct make_index_seq {
+    typedef typename seq_cat<typename make_index_seq<N / 2>::type,
+        typename make_index_seq<N - N / 2>::type>::type type;
+};
+template<> struct make_index_seq<0> { typedef index_seq<> type; };
+template<> struct make_index_seq<1> { typedef index_seq<0> type; };
+
+constexpr unsigned ss_log2(size_t k) {
+    return k < 2 ? 0 : 1 + ss_log2(k / 2);
+}
+
+// depth of perfect tree of at least n nodes
+constexpr unsigned ss_depth(size_t n) {
+    return n == 0 ? 0 : 1 + ss_log2(n);
+}
+
+// in-order position of node k of perfect tree of depth d
+constexpr size_t ss_rank(size_t k, unsigned d) {
+    return (2 * (k - ((size_t)1 << ss_log2(k))) + 1) *
+        ((size_t)1 << (d - 1 - ss_log2(k))) - 1;
+}
+
+// check a[lo, hi) is sorted, recursion depth is log n
+template<typename T>
+constexpr bool ss_sorted(const T *a, size_t lo, size_t hi) {
+    return hi - lo < 2 || (ss_sorted(a, lo, (lo + hi) / 2) &&
+        ss_sorted(a, (lo + hi) / 2, hi) &&
+        !(a[(lo + hi) / 2] < a[(lo + hi) / 2 - 1]));
+}
+
+// L levels of descent from node k
+template<typename T, unsigned L> struct ss_descend {
+    static constexpr size_t run(const T *keys, const T& t, size_t k) {
+        return ss_descend<T, L - 1>::run(keys, t, 2 * k + !(t < keys[k]));
+    }
+};
+
+template<typename T> struct ss_descend<T, 0> {
+    static constexpr size_t run(const T *, const T&, size_t k) {
+        return k;
+    }
+};
+
+} // namespace detail
+
+template<typename T, size_t N>
+class static_search {
+    static_assert(N > 0, "empty table");
+    static_assert(std::numeric_limits<T>::is_specialized,
+        "maximum value of the type is needed for padding");
+
+    static constexpr unsigned depth = detail::ss_depth(N);
+    static constexpr size_t nodes = ((size_t)1 << depth) - 1;
+
+    typedef T array_t[N];
+
+    T m_sorted[N];         // the table
+    T m_keys[nodes + 1];   // tree, node 0 is unused
+
+    static constexpr const array_t& check(const array_t& a) {
+        return detail::ss_sorted(a, 0, N) ? a :
+            (throw std::invalid_argument("static_search: unsorted"), a);
+    }
+
+    static constexpr T key(const array_t& a, size_t k) {
+        return k == 0 ? T() : detail::ss_rank(k, depth) < N ?
+            a[detail::ss_rank(k, depth)] : std::numeric_limits<T>::max();
+    }
+
+    template<size_t... I, size_t... K>
+    constexpr static_search(const array_t& a, detail::index_seq<I...>,
+            detail::index_seq<K...>)
+        : m_sorted{ a[I]... }, m_keys{ key(a, K)... }
+    {}
+
+    // path bits below the root of perfect tree are the number
+    // of elements not greater than t
+    static constexpr size_t result(size_t k) {
+        return k - ((size_t)1 << depth) < N ? k - ((size_t)1 << depth) : N;
+    }
+
+public:
+    // from sorted array, throws std::invalid_argument (compilation
+    // error if constexpr) if it is not sorted
+    constexpr static_search(const array_t& a)
+        : static_search(check(a),
+            typename detail::make_index_seq<N>::type(),
+            typename detail::make_index_seq<nodes + 1>::type())
+    {}
+
+    constexpr size_t size() const { return N; }
+
+    constexpr const T& operator[](size_t i) const { return m_sorted[i]; }
+
+    // position of the first element greater than t or size()
+    constexpr size_t upper_bound_index(const T& t) const {
+        return result(detail::ss_descend<T, depth>::run(m_keys, t, 1));
+    }
+
+    // first element greater than t or 0, same as bsearch()
+    const T *upper_bound(const T& t) const {
+        size_t i = upper_bound_index(t);
+        return i < N ? m_sorted + i : 0;
+    }
+};
+
+template<typename T, size_t N>
+constexpr static_search<T, N> make_static_search(const T (&a)[N]) {
+    return static_search<T, N>(a);
+}
+
+} // namespace algorithm
+} // namespace neutx
+
+#endif // _NEUTX_ALGORITHM_STATIC_SEARCH_HPP_
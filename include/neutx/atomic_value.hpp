@@ -25,42 +25,102 @@ at http://www.boost.org/LICENSE_1_0.txt)
 #ifndef _NEUTX_ATOMIC_ATOMIC_VALUE_HPP_
 #define _NEUTX_ATOMIC_ATOMIC_VALUE_HPP_
 
+#include <atomic>
+
 namespace neutx {
 namespace atomic {
 
+/// Integral value with atomic operations. Operations take optional
+/// memory order, sequentially consistent by default as the former
+/// __sync based implementation; counters that order nothing else may
+/// use std::memory_order_relaxed, flags publishing data may use
+/// release stores paired with acquire loads.
 template<typename T>
 class atomic_value {
-    volatile T val;
+    std::atomic<T> val;
 
 public:
-    atomic_value(T a_val = 0) : val(a_val) {} 
-    T get() const { return val; }
+    atomic_value(T a_val = 0) : val(a_val) {}
+
+    // copies snapshot of the value, as former volatile member did
+    atomic_value(const atomic_value& a) : val(a.get()) {}
+    atomic_value& operator=(const atomic_value& a) {
+        set(a.get());
+        return *this;
+    }
+
+    T get(std::memory_order a_order = std::memory_order_seq_cst) const {
+        return val.load(a_order);
+    }
+    void set(T a_val, std::memory_order a_order = std::memory_order_seq_cst) {
+        val.store(a_val, a_order);
+    }
+
+    // add/subtract returning old value
+    T fetch_add(T a_add,
+            std::memory_order a_order = std::memory_order_seq_cst) {
+        return val.fetch_add(a_add, a_order);
+    }
+    T fetch_sub(T a_sub,
+            std::memory_order a_order = std::memory_order_seq_cst) {
+        return val.fetch_sub(a_sub, a_order);
+    }
+    // replace value returning old value
+    T exchange(T a_new,
+            std::memory_order a_order = std::memory_order_seq_cst) {
+        return val.exchange(a_new, a_order);
+    }
+    // replace value equal to a_expected, otherwise load current value
+    // into a_expected; may fail spuriously, so is to be used in a loop
+    bool compare_exchange_weak(T& a_expected, T a_new,
+            std::memory_order a_order = std::memory_order_seq_cst) {
+        return val.compare_exchange_weak(a_expected, a_new, a_order,
+            fail_order(a_order));
+    }
+    bool compare_exchange_strong(T& a_expected, T a_new,
+            std::memory_order a_order = std::memory_order_seq_cst) {
+        return val.compare_exchange_strong(a_expected, a_new, a_order,
+            fail_order(a_order));
+    }
 
-    bool cas(T a_old, T a_new) {
-        return __sync_bool_compare_and_swap(&val, a_old, a_new);
+    bool cas(T a_old, T a_new,
+            std::memory_order a_order = std::memory_order_seq_cst) {
+        return compare_exchange_strong(a_old, a_new, a_order);
     }
     // prefix ++: ++val, returning new val
     T operator++() {
-        return __sync_add_and_fetch(&val, 1);
+        return val.fetch_add(1) + 1;
     }
     // postfix ++: val++, returning old val
     T operator++(int) {
-        return __sync_fetch_and_add(&val, 1);
+        return val.fetch_add(1);
     }
     void operator +=(T a_add) {
-        __sync_fetch_and_add(&val, a_add);
+        val.fetch_add(a_add);
     }
     void operator -=(T a_sub) {
-        __sync_fetch_and_sub(&val, a_sub);
+        val.fetch_sub(a_sub);
+    }
+    T operator&(T a_bits) const {
+        return val.load() & a_bits;
     }
-    T operator&(T a_bits) {
-        return val & a_bits;
+    void bclear(T a_bits,
+            std::memory_order a_order = std::memory_order_seq_cst) {
+        val.fetch_and(~a_bits, a_order);
     }
-    void bclear(T a_bits) {
-        __sync_fetch_and_and(&val, ~a_bits);
+    void bset(T a_bits,
+            std::memory_order a_order = std::memory_order_seq_cst) {
+        val.fetch_or(a_bits, a_order);
     }
-    void bset(T a_bits) {
-        __sync_fetch_and_or(&val, a_bits);
+
+private:
+    // strongest order allowed for failed compare-exchange
+    static std::memory_order fail_order(std::memory_order a_order) {
+        switch (a_order) {
+            case std::memory_order_acq_rel: return std::memory_order_acquire;
+            case std::memory_order_release: return std::memory_order_relaxed;
+            default:                        return a_order;
+        }
     }
 };
 
@@ -0,0 +1,110 @@
+// ex: ts=4 sw=4 ft=cpp et indentexpr=
+/**
+ * \file
+ * \brief in-memory output store placed at given offset
+ *
+ * Chunk addresses are offsets in the output the buffer is going to be
+ * written to at known position, so the buffer may be built apart from
+ * the output, e.g. by another thread. With keep == false only the size
+ * is counted.
+ *
+ * \author Dmitriy Kargapolov
+ * \since 19 October 2026
+ *
+ */
+
+/*
+ * Copyright (C) 2026 Dmitriy Kargapolov <dmitriy.kargapolov@gmail.com>
+ * Use, modification and distribution are subject to the Boost Software
+ * License, Version 1.0 (See accompanying file LICENSE_1_0.txt or copy
+ * at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef _NEUTX_CONTAINER_DETAIL_BUFFER_STORE_HPP_
+#define _NEUTX_CONTAINER_DETAIL_BUFFER_STORE_HPP_
+
+#include <string>
+#include <stdexcept>
+#include <boost/numeric/conversion/cast.hpp>
+
+namespace neutx {
+namespace container {
+namespace detail {
+
+template<typename AddrType>
+class buffer_store {
+    std::string m_data;
+    uint64_t m_base;  // output position of the buffer
+    uint64_t m_size;
+    bool m_keep;
+
+public:
+    typedef AddrType pointer_t;
+    typedef std::pair<const void *, size_t> buf_t;
+
+    buffer_store(uint64_t a_base, bool a_keep = true)
+        : m_base(a_base), m_size(0), m_keep(a_keep)
+    {}
+
+    static pointer_t null() { return 0; }
+
+    // offset of the next chunk to be written
+    pointer_t pos() const {
+        return boost::numeric_cast<pointer_t>(m_base + m_size);
+    }
+
+    // bytes written
+    uint64_t size() const { return m_size; }
+
+    // content, empty if not kept
+    std::string& data() { return m_data; }
+
+    pointer_t store(const buf_t& b) {
+        if (b.first == 0 || b.second == 0)
+            return 0;
+        pointer_t ret = pos();
+        if (m_keep)
+            m_data.append((const char *)b.first, b.second);
+        m_size += b.second;
+        return ret;
+    }
+
+    pointer_t store(const buf_t& b1, const buf_t& b2) {
+        pointer_t ret1 = store(b1);
+        pointer_t ret2 = store(b2);
+        return ret1 ? ret1 : ret2;
+    }
+
+    pointer_t store(const buf_t& b1, const buf_t& b2, const buf_t& b3) {
+        pointer_t ret = store(b1);
+        pointer_t tmp;
+        tmp = store(b2); if (!ret) ret = tmp;
+        tmp = store(b3); if (!ret) ret = tmp;
+        return ret;
+    }
+
+    pointer_t store(const buf_t& b1, const buf_t& b2, const buf_t& b3,
+            const buf_t& b4) {
+        pointer_t ret = store(b1);
+        pointer_t tmp;
+        tmp = store(b2); if (!ret) ret = tmp;
+        tmp = store(b3); if (!ret) ret = tmp;
+        tmp = store(b4); if (!ret) ret = tmp;
+        return ret;
+    }
+
+    void store_at(pointer_t addr, pointer_t off, const buf_t& buff) {
+        uint64_t at = (uint64_t)addr + off;
+        if (at < m_base || at - m_base + buff.second > m_size)
+            throw std::out_of_range("buffer_store: bad position");
+        if (m_keep)
+            m_data.replace(at - m_base, buff.second,
+                (const char *)buff.first, buff.second);
+    }
+};
+
+} // namespace detail
+} // namespace container
+} // namespace neutx
+
+#endif // _NEUTX_CONTAINER_DETAIL_BUFFER_STORE_HPP_
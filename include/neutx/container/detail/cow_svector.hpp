@@ -0,0 +1,221 @@
+// ex: ts=4 sw=4 ft=cpp et indentexpr=
+/**
+ * \file
+ * \brief sparse array - copy-on-write implementation
+ *
+ * Drop-in replacement of neutx::container::detail::svector for tries
+ * read concurrently with updates. Elements are kept in immutable array
+ * along with the mask, insertion builds new array and publishes it with
+ * single release store, so reader sees either old or new array, never
+ * a partially updated one. Old array is freed right away or, if node
+ * store is passed to ensure(), retired to the store to be freed when
+ * no reader can still use it (see epoch_node_store).
+ *
+ * \author Dmitriy Kargapolov
+ * \since 19 October 2026
+ *
+ */
+
+/*
+ * Copyright (C) 2026 Dmitriy Kargapolov <dmitriy.kargapolov@gmail.com>
+ * Use, modification and distribution are subject to the Boost Software
+ * License, Version 1.0 (See accompanying file LICENSE_1_0.txt or copy
+ * at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef _NEUTX_CONTAINER_DETAIL_COW_SVECTOR_HPP_
+#define _NEUTX_CONTAINER_DETAIL_COW_SVECTOR_HPP_
+
+#include <neutx/container/detail/idxmap.hpp>
+#include <atomic>
+#include <memory>
+#include <string.h>
+#include <type_traits>
+
+namespace neutx {
+namespace container {
+namespace detail {
+
+template <typename Data = char, typename IdxMap = idxmap<1>,
+          typename Alloc = std::allocator<char> >
+class cow_svector {
+    typedef typename IdxMap::mask_t mask_t;
+    typedef typename IdxMap::index_t index_t;
+    typedef typename Alloc::template rebind<char>::other alloc_t;
+
+public:
+    typedef typename IdxMap::symbol_t symbol_t;
+    typedef typename IdxMap::bad_symbol bad_symbol;
+
+private:
+    static_assert(std::is_trivially_copyable<Data>::value,
+        "elements are copied as raw memory");
+
+    // immutable array of elements
+    struct block {
+        mask_t mask;
+        index_t size;
+        Data items[1];
+
+        static size_t bytes(index_t n) {
+            return sizeof(block) + (n > 1 ? n - 1 : 0) * sizeof(Data);
+        }
+    };
+
+    std::atomic<block *> m_block;
+    static IdxMap m_map;
+
+    // prevent copying
+    cow_svector(const cow_svector&);
+    cow_svector& operator=(const cow_svector&);
+
+    const block *load() const {
+        return m_block.load(std::memory_order_acquire);
+    }
+
+    static void free_block(void *a_ptr) {
+        block *b = static_cast<block *>(a_ptr);
+        alloc_t().deallocate((char *)b, block::bytes(b->size));
+    }
+
+    // copy of b with new element inserted at given position
+    static block *insert(const block *b, mask_t a_mask, index_t a_index,
+            const Data& a_new) {
+        index_t n = b ? b->size : 0;
+        block *r = (block *)alloc_t().allocate(block::bytes(n + 1));
+        r->mask = (b ? b->mask : 0) | a_mask;
+        r->size = n + 1;
+        if (a_index > 0)
+            memcpy(&r->items[0], &b->items[0], a_index * sizeof(Data));
+        r->items[a_index] = a_new;
+        if (a_index < n)
+            memcpy(&r->items[a_index + 1], &b->items[a_index],
+                (n - a_index) * sizeof(Data));
+        return r;
+    }
+
+    template<typename C, typename R>
+    Data& do_ensure(symbol_t a_symbol, C& create, R *a_reclaim) {
+        block *b = m_block.load(std::memory_order_relaxed);
+        mask_t l_mask; index_t l_index;
+        m_map.index(b ? b->mask : 0, a_symbol, l_mask, l_index);
+        if (b && (l_mask & b->mask) != 0)
+            return b->items[l_index];
+        block *r = insert(b, l_mask, l_index, create());
+        m_block.store(r, std::memory_order_release);
+        if (b) {
+            if (a_reclaim)
+                a_reclaim->retire(b, &free_block);
+            else
+                free_block(b);
+        }
+        return r->items[l_index];
+    }
+
+    // stand-in for absent reclaimer
+    struct no_reclaim { void retire(void *, void (*)(void *)) {} };
+
+public:
+    template<typename U>
+    struct rebind { typedef cow_svector<U, IdxMap, Alloc> other; };
+
+    cow_svector() : m_block(0) {}
+
+    ~cow_svector() {
+        block *b = m_block.load(std::memory_order_relaxed);
+        if (b)
+            free_block(b);
+    }
+
+    // find an element by symbol
+    const Data* get(symbol_t a_symbol) const {
+        const block *b = load();
+        if (!b)
+            return 0;
+        mask_t l_mask; index_t l_index;
+        m_map.index(b->mask, a_symbol, l_mask, l_index);
+        if ((l_mask & b->mask) != 0)
+            return &b->items[l_index];
+        else
+            return 0;
+    }
+
+    // find an element by symbol, if not found, check if
+    // left adjacent element exists
+    std::pair<bool, const Data*> get_left(symbol_t a_symbol) const {
+        const block *b = load();
+        mask_t l_mask; index_t l_index;
+        m_map.index(b ? b->mask : 0, a_symbol, l_mask, l_index);
+        if (b && (l_mask & b->mask) != 0)
+            return std::make_pair(false, &b->items[l_index]);
+        else if (l_index > 0)
+            return std::make_pair(true, &b->items[l_index - 1]);
+        else
+            return std::make_pair(false, nullptr);
+    }
+
+    // find element, if not found - create new element calling
+    // functor of type C with no arguments, insert it into the
+    // collection and return reference to the new element;
+    // replaced array is freed immediately
+    template<typename C> Data& ensure(symbol_t a_symbol, C create) {
+        return do_ensure(a_symbol, create, (no_reclaim *)0);
+    }
+
+    // same, replaced array is retired to the store R providing
+    // retire(void *, void (*)(void *)) method
+    template<typename C, typename R>
+    Data& ensure(symbol_t a_symbol, C create, R& a_reclaim) {
+        return do_ensure(a_symbol, create, &a_reclaim);
+    }
+
+    // number of elements
+    size_t size() const {
+        const block *b = load();
+        return b ? b->size : 0;
+    }
+
+    // bytes allocated for elements, arrays are allocated exactly
+    size_t mem_bytes() const {
+        const block *b = load();
+        return b ? block::bytes(b->size) : 0;
+    }
+
+    size_t spare_bytes() const { return 0; }
+
+    // call functor for each value
+    template<typename F> void foreach_value(F f) const {
+        const block *b = load();
+        for (index_t i = 0; b && i < b->size; ++i)
+            f(b->items[i]);
+    }
+
+    // key to key-val functor adapter
+    template<typename F>
+    class k2kv {
+        const Data *i_;
+        F& f_;
+    public:
+        k2kv(const Data *i, F& f) : i_(i), f_(f) {}
+        template<typename U>
+        void operator()(U k) {
+            f_(k, *i_); ++i_;
+        }
+    };
+
+    // call functor for each key-value pair
+    template<typename F> void foreach_keyval(F f) const {
+        const block *b = load();
+        if (b)
+            IdxMap::foreach(b->mask, k2kv<F>(&b->items[0], f));
+    }
+};
+
+template <typename Data, typename IdxMap, typename Alloc>
+IdxMap cow_svector<Data, IdxMap, Alloc>::m_map;
+
+} // namespace detail
+} // namespace container
+} // namespace neutx
+
+#endif // _NEUTX_CONTAINER_DETAIL_COW_SVECTOR_HPP_
@@ -0,0 +1,92 @@
+// ex: ts=4 sw=4 ft=cpp et indentexpr=
+/**
+ * \file
+ * \brief deduplicating data codec adapter
+ *
+ * Wraps any data codec so that identical encoded payloads are written
+ * to the output store only once, later nodes referencing the address
+ * of the first copy.
+ *
+ * \author Dmitriy Kargapolov
+ * \since 19 October 2026
+ *
+ */
+
+/*
+ * Copyright (C) 2026 Dmitriy Kargapolov <dmitriy.kargapolov@gmail.com>
+ * Use, modification and distribution are subject to the Boost Software
+ * License, Version 1.0 (See accompanying file LICENSE_1_0.txt or copy
+ * at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef _NEUTX_CONTAINER_DETAIL_DEDUP_CODEC_HPP_
+#define _NEUTX_CONTAINER_DETAIL_DEDUP_CODEC_HPP_
+
+#include <neutx/container/detail/dedup_store.hpp>
+
+namespace neutx {
+namespace container {
+namespace detail {
+
+// encoder with no shared state
+struct no_state {};
+
+namespace internal {
+template<typename T> struct void_type { typedef void type; };
+}
+
+// type of the state shared by all instances of given data encoder
+// during one export, encoder declares it as nested state_type
+template<typename E, typename = void>
+struct encoder_state { typedef no_state type; };
+
+template<typename E>
+struct encoder_state<E, typename internal::void_type<
+    typename E::state_type>::type> {
+    typedef typename E::state_type type;
+};
+
+// data encoder adapter, parent (encoder traits instance) must expose
+// data_state() method returning reference to dedup_dictionary<AddrType>
+template<typename AddrType, typename Encoder>
+class dedup_encoder {
+    Encoder m_encoder;
+    dedup_dictionary<AddrType>& m_dict;
+
+public:
+    typedef std::pair<const void *, size_t> buf_t;
+    typedef dedup_dictionary<AddrType> state_type;
+
+    // encoder always initialized with parent state
+    template<typename T> dedup_encoder(T& parent)
+        : m_encoder(parent), m_dict(parent.data_state())
+    {}
+
+    template<typename Data, typename StoreIn, typename StoreOut>
+    void store(const Data& data, const StoreIn& in, StoreOut& out) {
+        dedup_store<StoreOut, AddrType> l_out(m_dict, out);
+        m_encoder.store(data, in, l_out);
+    }
+
+    const buf_t& buff() const { return m_encoder.buff(); }
+};
+
+// public codec interface, DataCodec is any codec exposing
+// bind<AddrType>::data_type and bind<AddrType>::encoder
+//
+template<typename DataCodec>
+struct dedup_codec {
+    template<typename AddrType>
+    struct bind {
+        typedef typename DataCodec::template bind<AddrType>::data_type
+            data_type;
+        typedef dedup_encoder<AddrType,
+            typename DataCodec::template bind<AddrType>::encoder> encoder;
+    };
+};
+
+} // namespace detail
+} // namespace container
+} // namespace neutx
+
+#endif // _NEUTX_CONTAINER_DETAIL_DEDUP_CODEC_HPP_
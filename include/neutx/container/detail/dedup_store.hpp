@@ -0,0 +1,128 @@
+// ex: ts=4 sw=4 ft=cpp et indentexpr=
+/**
+ * \file
+ * \brief deduplicating output store proxy
+ *
+ * \author Dmitriy Kargapolov
+ * \since 19 October 2026
+ *
+ */
+
+/*
+ * Copyright (C) 2026 Dmitriy Kargapolov <dmitriy.kargapolov@gmail.com>
+ * Use, modification and distribution are subject to the Boost Software
+ * License, Version 1.0 (See accompanying file LICENSE_1_0.txt or copy
+ * at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef _NEUTX_CONTAINER_DETAIL_DEDUP_STORE_HPP_
+#define _NEUTX_CONTAINER_DETAIL_DEDUP_STORE_HPP_
+
+#include <string>
+#include <boost/unordered_map.hpp>
+
+namespace neutx {
+namespace container {
+namespace detail {
+
+// dictionary of chunks already written: encoded bytes -> address
+template<typename AddrType>
+class dedup_dictionary {
+    typedef boost::unordered_map<std::string, AddrType> map_t;
+    map_t m_map;
+    size_t m_hits;
+    size_t m_saved;
+
+public:
+    dedup_dictionary() : m_hits(0), m_saved(0) {}
+
+    // address of previously written chunk with same content or 0
+    AddrType find(const std::string& key) {
+        typename map_t::const_iterator it = m_map.find(key);
+        if (it == m_map.end())
+            return 0;
+        ++m_hits;
+        m_saved += key.size();
+        return it->second;
+    }
+
+    void insert(const std::string& key, AddrType addr) {
+        m_map.insert(typename map_t::value_type(key, addr));
+    }
+
+    // number of distinct chunks written
+    size_t size() const { return m_map.size(); }
+
+    // number of chunks not written due to deduplication
+    size_t hits() const { return m_hits; }
+
+    // number of bytes not written due to deduplication
+    size_t saved() const { return m_saved; }
+};
+
+// output store proxy writing each distinct chunk only once
+template<typename Out, typename AddrType>
+class dedup_store {
+    typedef dedup_dictionary<AddrType> dict_t;
+    dict_t& m_dict;
+    Out& m_out;
+
+    static void append(std::string& key, const std::pair<const void *,
+            size_t>& b) {
+        if (b.first && b.second)
+            key.append((const char *)b.first, b.second);
+    }
+
+    AddrType lookup(const std::string& key) {
+        return key.empty() ? 0 : m_dict.find(key);
+    }
+
+    AddrType remember(const std::string& key, AddrType addr) {
+        if (addr != 0)
+            m_dict.insert(key, addr);
+        return addr;
+    }
+
+public:
+    typedef AddrType pointer_t;
+    typedef std::pair<const void *, size_t> buf_t;
+
+    dedup_store(dict_t& a_dict, Out& a_out) : m_dict(a_dict), m_out(a_out) {}
+
+    pointer_t null() const { return m_out.null(); }
+
+    pointer_t store(const buf_t& b) {
+        std::string key;
+        append(key, b);
+        pointer_t ret = lookup(key);
+        return ret ? ret : remember(key, m_out.store(b));
+    }
+
+    pointer_t store(const buf_t& b1, const buf_t& b2) {
+        std::string key;
+        append(key, b1); append(key, b2);
+        pointer_t ret = lookup(key);
+        return ret ? ret : remember(key, m_out.store(b1, b2));
+    }
+
+    pointer_t store(const buf_t& b1, const buf_t& b2, const buf_t& b3) {
+        std::string key;
+        append(key, b1); append(key, b2); append(key, b3);
+        pointer_t ret = lookup(key);
+        return ret ? ret : remember(key, m_out.store(b1, b2, b3));
+    }
+
+    pointer_t store(const buf_t& b1, const buf_t& b2, const buf_t& b3,
+            const buf_t& b4) {
+        std::string key;
+        append(key, b1); append(key, b2); append(key, b3); append(key, b4);
+        pointer_t ret = lookup(key);
+        return ret ? ret : remember(key, m_out.store(b1, b2, b3, b4));
+    }
+};
+
+} // namespace detail
+} // namespace container
+} // namespace neutx
+
+#endif // _NEUTX_CONTAINER_DETAIL_DEDUP_STORE_HPP_
@@ -0,0 +1,272 @@
+// ex: ts=4 sw=4 ft=cpp et indentexpr=
+/**
+ * \file
+ * \brief double-array (BASE/CHECK) trie encoding
+ *
+ * Read-only trie layout where transition from state s by symbol c is
+ * t = BASE[s] + code(c), valid if CHECK[t] == s: one array access and
+ * one comparison per key symbol. Root state is 1, state 0 is unused,
+ * free units have CHECK 0. Node payloads are kept in separate array
+ * indexed by state, suffix links (if exported from aho-corasick trie)
+ * in yet another one.
+ *
+ * Writing side consists of builder_coll_encoder, da_builder output store
+ * proxy and da_trie_codec writer. Reading side is da_index, used by
+ * neutx::container::mmap_da_trie.
+ *
+ * \author Dmitriy Kargapolov
+ * \since 19 October 2026
+ *
+ */
+
+/*
+ * Copyright (C) 2026 Dmitriy Kargapolov <dmitriy.kargapolov@gmail.com>
+ * Use, modification and distribution are subject to the Boost Software
+ * License, Version 1.0 (See accompanying file LICENSE_1_0.txt or copy
+ * at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef _NEUTX_CONTAINER_DETAIL_DOUBLE_ARRAY_HPP_
+#define _NEUTX_CONTAINER_DETAIL_DOUBLE_ARRAY_HPP_
+
+#include <neutx/container/detail/idxmap.hpp>
+#include <neutx/container/detail/default_ptrie_codec.hpp>
+#include <neutx/container/detail/trie_builder.hpp>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include <deque>
+#include <stdexcept>
+
+namespace neutx {
+namespace container {
+namespace detail {
+
+// transition unit
+struct da_unit {
+    uint32_t base;
+    uint32_t check;
+};
+
+// suffix link of the state
+struct da_link {
+    uint32_t suffix; // suffix state or 0
+    uint32_t shift;  // suffix distance
+};
+
+// on-disk header, followed by the trie trailer (header address)
+template<typename AddrType>
+struct da_header {
+    uint64_t units;     // number of units
+    uint32_t data_size; // size of encoded node data
+    uint32_t links;     // suffix links present
+    AddrType unit;      // units array
+    AddrType data;      // payloads array, indexed by state
+    AddrType link;      // suffix links array, indexed by state, or 0
+};
+
+enum {
+    da_root = 1,     // root state
+    da_codes = 10    // codes of digit symbols are 1..10
+};
+
+/**
+ * \brief output store proxy writing collected trie nodes as double array
+ * \tparam Out output store type to write resulting image to
+ */
+template<typename Out>
+class da_builder : public node_collector<Out> {
+    typedef node_collector<Out> base_t;
+
+public:
+    typedef typename base_t::pointer_t pointer_t;
+    typedef typename base_t::buf_t buf_t;
+
+    template<typename A>
+    da_builder(const A& a) : base_t(a) {}
+
+    // place trie rooted at given node, write the image,
+    // return header address
+    pointer_t finish(pointer_t root) {
+        size_t n = this->size();
+        std::vector<da_unit> units(da_root + da_codes + 1);
+        std::vector<bool> used(units.size());
+        std::vector<uint32_t> state(n);
+        used[0] = used[da_root] = true;
+
+        // breadth-first placement, first fit
+        std::deque<uint64_t> queue;
+        queue.push_back(root - 1);
+        state[root - 1] = da_root;
+        uint64_t next_free = da_root + 1;
+        while (!queue.empty()) {
+            uint64_t x = queue.front();
+            queue.pop_front();
+            size_t b = this->edges_begin(x), e = this->edges_end(x);
+            if (b == e)
+                continue;
+            while (next_free < used.size() && used[next_free])
+                ++next_free;
+            uint64_t c0 = code(this->m_labels[b]);
+            uint64_t base = next_free > c0 ? next_free - c0 : 1;
+            for (;; ++base) {
+                bool ok = true;
+                for (size_t i = b; ok && i < e; ++i) {
+                    uint64_t t = base + code(this->m_labels[i]);
+                    ok = t >= used.size() || !used[t];
+                }
+                if (ok)
+                    break;
+            }
+            if (base + da_codes >= UINT32_MAX)
+                throw std::out_of_range("da_builder: too many units");
+            if (base + da_codes + 1 > units.size()) {
+                da_unit zero = { 0, 0 };
+                units.resize(base + da_codes + 1, zero);
+                used.resize(units.size());
+            }
+            uint32_t s = state[x];
+            units[s].base = base;
+            for (size_t i = b; i < e; ++i) {
+                uint32_t t = base + code(this->m_labels[i]);
+                used[t] = true;
+                units[t].check = s;
+                state[this->m_targets[i]] = t;
+                queue.push_back(this->m_targets[i]);
+            }
+        }
+
+        // payloads and suffix links, indexed by state
+        size_t ds = this->m_data_size;
+        std::vector<char> data(units.size() * ds);
+        std::vector<da_link> links;
+        if (this->m_links) {
+            da_link zero = { 0, 0 };
+            links.resize(units.size(), zero);
+        }
+        for (size_t x = 0; x < n; ++x) {
+            uint32_t s = state[x];
+            if (s == 0)
+                continue;
+            if (ds)
+                memcpy(&data[s * ds], this->data(x), ds);
+            if (this->m_links && this->m_suffix[x]) {
+                links[s].suffix = state[this->m_suffix[x] - 1];
+                links[s].shift = this->m_shift[x];
+            }
+        }
+
+        da_header<pointer_t> h;
+        memset(&h, 0, sizeof(h));
+        h.units = units.size();
+        h.data_size = ds;
+        h.links = this->m_links;
+        this->align();
+        h.unit = this->store_vector(units);
+        this->align();
+        h.data = this->store_vector(data);
+        this->align();
+        h.link = this->store_vector(links);
+        return this->m_out.store(buf_t(&h, sizeof(h)));
+    }
+
+private:
+    static uint64_t code(char sym) { return sym - '0' + 1; }
+};
+
+// trie writer and root finder
+struct da_trie_codec {
+    template<typename AddrType>
+    struct bind {
+        typedef builder_trie_writer<AddrType> encoder;
+        typedef typename mmap_trie_codec_impl<AddrType>::get_root root_finder;
+        typedef builder_coll_encoder<AddrType> coll_encoder;
+        typedef void builder_tag;
+        template<typename Out>
+        struct store { typedef da_builder<Out> type; };
+    };
+};
+
+/**
+ * \brief read-only view of double-array trie image
+ */
+template<typename AddrType>
+class da_index {
+    const da_unit *m_units;
+    const da_link *m_links;
+    const char *m_data;
+    uint64_t m_size;
+    size_t m_data_size;
+
+    const char *region(const char *base, size_t size, AddrType off,
+            uint64_t len) const {
+        if (len == 0)
+            return 0;
+        if (off == 0 || off > size || len > size - off)
+            throw std::invalid_argument("da_index: bad offset");
+        return base + off;
+    }
+
+public:
+    typedef idxmap<1>::symbol_t symbol_t;
+    typedef idxmap<1>::bad_symbol bad_symbol;
+
+    da_index(const void *a_addr, size_t a_size, AddrType a_head) {
+        const char *base = (const char *)a_addr;
+        if (a_head == 0 || a_head > a_size ||
+                sizeof(da_header<AddrType>) > a_size - a_head)
+            throw std::invalid_argument("da_index: bad header offset");
+        da_header<AddrType> h;
+        memcpy(&h, base + a_head, sizeof(h));
+        if (h.units < da_root + da_codes + 1)
+            throw std::invalid_argument("da_index: short units array");
+        m_size = h.units;
+        m_data_size = h.data_size;
+        m_units = (const da_unit *)region(base, a_size, h.unit,
+            h.units * sizeof(da_unit));
+        m_data = region(base, a_size, h.data, h.units * h.data_size);
+        m_links = h.links ? (const da_link *)region(base, a_size, h.link,
+            h.units * sizeof(da_link)) : 0;
+    }
+
+    uint64_t size() const { return m_size; }
+    size_t data_size() const { return m_data_size; }
+    bool has_links() const { return m_links != 0; }
+
+    // state reached from s by symbol or 0
+    uint32_t child(uint32_t s, symbol_t sym) const {
+        unsigned c = sym - '0';
+        if (c >= da_codes)
+            throw bad_symbol(sym);
+        uint32_t t = m_units[s].base + c + 1;
+        return m_units[t].check == s ? t : 0;
+    }
+
+    // child of state s with given symbol; if missing, nearest child with
+    // lesser symbol is returned setting left flag, or 0 if none
+    uint32_t child_left(uint32_t s, symbol_t sym, bool& left) const {
+        uint32_t t = child(s, sym);
+        left = false;
+        if (t)
+            return t;
+        for (symbol_t c = sym; c > '0'; ) {
+            if ((t = child(s, --c))) {
+                left = true;
+                return t;
+            }
+        }
+        return 0;
+    }
+
+    // encoded data of the state
+    const char *data(uint32_t s) const { return m_data + s * m_data_size; }
+
+    // suffix link of the state, has_links() must be true
+    const da_link& link(uint32_t s) const { return m_links[s]; }
+};
+
+} // namespace detail
+} // namespace container
+} // namespace neutx
+
+#endif // _NEUTX_CONTAINER_DETAIL_DOUBLE_ARRAY_HPP_
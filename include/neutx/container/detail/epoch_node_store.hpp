@@ -0,0 +1,216 @@
+// ex: ts=4 sw=4 ft=cpp et indentexpr=
+/**
+ * \file
+ * \brief strie node storage facility with epoch based reclamation
+ *
+ * Node store for ptrie updated by single writer thread while any number
+ * of reader threads run fold(), fold_full(), left_bound() or foreach()
+ * without locks. Readers pin current epoch for the duration of a call
+ * (see read_guard), writer retires memory unlinked from the trie (e.g.
+ * replaced child arrays of cow_svector), which is freed once no reader
+ * pinned at or before the retire epoch remains.
+ *
+ * \author Dmitriy Kargapolov
+ * \since 19 October 2026
+ *
+ */
+
+/*
+ * Copyright (C) 2026 Dmitriy Kargapolov <dmitriy.kargapolov@gmail.com>
+ * Use, modification and distribution are subject to the Boost Software
+ * License, Version 1.0 (See accompanying file LICENSE_1_0.txt or copy
+ * at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef _NEUTX_CONTAINER_DETAIL_EPOCH_NODE_STORE_HPP_
+#define _NEUTX_CONTAINER_DETAIL_EPOCH_NODE_STORE_HPP_
+
+#include <neutx/container/detail/simple_node_store.hpp>
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+
+namespace neutx {
+namespace container {
+namespace detail {
+
+/**
+ * \brief node store facility safe for single writer and many readers
+ * \tparam Node node type
+ * \tparam Allocator STL allocator to use
+ * \tparam MaxReaders number of reader slots, read_guard objects beyond
+ *         that share overflow slot holding back all reclamation
+ */
+template <typename Node = void, typename Allocator = std::allocator<char>,
+          unsigned MaxReaders = 64>
+class epoch_node_store {
+    typedef simple_node_store<Node, Allocator> base_t;
+
+    // reader slot, own cache line: 0 if free, or pinned epoch
+    struct alignas(64) slot_t {
+        std::atomic<uint64_t> epoch;
+    };
+
+    // memory waiting for readers to leave
+    struct retired_t {
+        void *ptr;
+        void (*free)(void *);
+        uint64_t epoch;
+    };
+
+    enum { reclaim_batch = 64 };
+
+public:
+    template<typename U>
+    struct rebind { typedef epoch_node_store<U, Allocator, MaxReaders> other; };
+
+    // this store provides allocate/deallocate methods
+    static const bool dynamic = true;
+
+    // this store supports concurrent readers (see ptrie::next_node)
+    static const bool concurrent = true;
+
+    // abstract node pointer
+    typedef typename base_t::pointer_t pointer_t;
+
+    // null pointer constant
+    static const pointer_t null;
+
+    // pins current epoch for the lifetime of the object,
+    // memory retired after that is not freed until it is destroyed
+    class read_guard {
+        const epoch_node_store& m_store;
+        slot_t *m_slot;  // null if counted in overflow slot
+
+        read_guard(const read_guard&);
+        read_guard& operator=(const read_guard&);
+
+    public:
+        read_guard(const epoch_node_store& a_store)
+            : m_store(a_store), m_slot(a_store.pin())
+        {}
+        ~read_guard() {
+            if (m_slot)
+                m_slot->epoch.store(0, std::memory_order_release);
+            else
+                m_store.m_overflow.epoch.fetch_sub(1,
+                    std::memory_order_release);
+        }
+    };
+
+    epoch_node_store() : m_epoch(1) { init(); }
+
+    epoch_node_store(const Allocator& a_alloc)
+        : m_store(a_alloc), m_epoch(1)
+    {
+        init();
+    }
+
+    // no readers may be active at this point
+    ~epoch_node_store() {
+        for (size_t i = 0; i < m_retired.size(); ++i)
+            m_retired[i].free(m_retired[i].ptr);
+    }
+
+    template<typename T>
+    pointer_t allocate() { return m_store.template allocate<T>(); }
+
+    // must not be used for nodes reachable by readers
+    template<typename T>
+    void deallocate(pointer_t a_ptr) { m_store.template deallocate<T>(a_ptr); }
+
+    // convert abstract pointer to native pointer
+    template<typename T>
+    T *native_pointer(pointer_t a_ptr) const {
+        return m_store.template native_pointer<T>(a_ptr);
+    }
+
+    size_t count() const { return m_store.count(); }
+
+    // writer: hand over memory already unlinked from the trie,
+    // it is freed by calling a_free when no reader can see it
+    void retire(void *a_ptr, void (*a_free)(void *)) {
+        retired_t r = { a_ptr, a_free,
+            m_epoch.fetch_add(1, std::memory_order_seq_cst) };
+        m_retired.push_back(r);
+        if (m_retired.size() >= m_reclaim_at)
+            reclaim();
+    }
+
+    // writer: free retired memory not visible to active readers,
+    // return number of objects still waiting
+    size_t reclaim() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        uint64_t l_min = UINT64_MAX;
+        for (unsigned i = 0; i < MaxReaders; ++i) {
+            uint64_t e = m_slots[i].epoch.load(std::memory_order_seq_cst);
+            if (e != 0 && e < l_min)
+                l_min = e;
+        }
+        // overflow readers may hold any epoch
+        if (m_overflow.epoch.load(std::memory_order_seq_cst) != 0)
+            l_min = 0;
+        size_t n = 0;
+        for (size_t i = 0; i < m_retired.size(); ++i) {
+            if (m_retired[i].epoch < l_min)
+                m_retired[i].free(m_retired[i].ptr);
+            else
+                m_retired[n++] = m_retired[i];
+        }
+        m_retired.resize(n);
+        // don't rescan on every retire if readers hold old epoch
+        m_reclaim_at = n + reclaim_batch;
+        return n;
+    }
+
+    // number of retired objects not yet freed
+    size_t retired() const { return m_retired.size(); }
+
+private:
+    // prevent copying
+    epoch_node_store(const epoch_node_store&);
+    epoch_node_store& operator=(const epoch_node_store&);
+
+    void init() {
+        m_reclaim_at = reclaim_batch;
+        for (unsigned i = 0; i < MaxReaders; ++i)
+            m_slots[i].epoch.store(0, std::memory_order_relaxed);
+        m_overflow.epoch.store(0, std::memory_order_relaxed);
+    }
+
+    // take free reader slot, publish current epoch in it; if all slots
+    // are taken count the reader in overflow slot and return null
+    slot_t *pin() const {
+        for (unsigned i = 0; i < MaxReaders; ++i) {
+            uint64_t l_free = 0;
+            uint64_t e = m_epoch.load(std::memory_order_seq_cst);
+            if (m_slots[i].epoch.load(std::memory_order_relaxed) == 0 &&
+                    m_slots[i].epoch.compare_exchange_strong(l_free, e,
+                        std::memory_order_seq_cst)) {
+                // order slot store before subsequent reads of the trie
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                return &m_slots[i];
+            }
+        }
+        m_overflow.epoch.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return 0;
+    }
+
+    base_t m_store;
+    std::atomic<uint64_t> m_epoch;
+    mutable slot_t m_slots[MaxReaders];
+    mutable slot_t m_overflow;  // number of readers without own slot
+    std::vector<retired_t> m_retired;
+    size_t m_reclaim_at;
+};
+
+template<typename Node, typename Allocator, unsigned MaxReaders>
+const typename epoch_node_store<Node, Allocator, MaxReaders>::pointer_t
+               epoch_node_store<Node, Allocator, MaxReaders>::null = 0;
+
+} // namespace detail
+} // namespace container
+} // namespace neutx
+
+#endif // _NEUTX_CONTAINER_DETAIL_EPOCH_NODE_STORE_HPP_
@@ -52,6 +52,11 @@ public:
 
     static pointer_t null() { return 0; }
 
+    // offset of the next chunk to be written
+    pointer_t pos() {
+        return boost::numeric_cast<pointer_t, std::streamoff>(m_ofs.tellp());
+    }
+
     pointer_t store(const buf_t& b) {
         if (b.first == 0 || b.second == 0)
             return 0;
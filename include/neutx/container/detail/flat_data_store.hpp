@@ -39,6 +39,10 @@ public:
     // this store does not provide allocate/deallocate methods
     static const bool dynamic = false;
 
+    // read-only store, no reader registration needed
+    static const bool concurrent = false;
+    struct read_guard { read_guard(const flat_data_store&) {} };
+
     // null pointer constant
     static const pointer_t null;
 
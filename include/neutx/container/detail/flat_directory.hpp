@@ -0,0 +1,218 @@
+// ex: ts=4 sw=4 ft=cpp et indentexpr=
+/**
+ * \file
+ * \brief flat file of named records with directory sorted by name
+ *
+ * File layout: 'F' byte written by file_store, records' data written
+ * by the owner format, names, directory of fixed size entries sorted by
+ * name, header, header offset. Entry is a format specific POD struct,
+ * its "name" member is set to the offset of NUL terminated name. The
+ * header holds the format magic and a compatibility word checked by
+ * the reader, e.g. sizes of native types stored in the file.
+ *
+ * \author Dmitriy Kargapolov
+ * \since 19 October 2026
+ *
+ */
+
+/*
+ * Copyright (C) 2026 Dmitriy Kargapolov <dmitriy.kargapolov@gmail.com>
+ * Use, modification and distribution are subject to the Boost Software
+ * License, Version 1.0 (See accompanying file LICENSE_1_0.txt or copy
+ * at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef _NEUTX_CONTAINER_DETAIL_FLAT_DIRECTORY_HPP_
+#define _NEUTX_CONTAINER_DETAIL_FLAT_DIRECTORY_HPP_
+
+#include <neutx/container/detail/file_store.hpp>
+#include <neutx/container/detail/flat_data_store.hpp>
+#include <neutx/container/detail/default_ptrie_codec.hpp>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+namespace neutx {
+namespace container {
+namespace detail {
+
+struct flat_dir_header {
+    char     magic[8];
+    uint32_t abi;      // format compatibility word
+    uint32_t pad;
+    uint64_t count;    // number of entries
+    uint64_t dir;      // offset of entries sorted by name
+};
+
+template<typename Entry, typename AddrType = uint64_t>
+class flat_dir_writer {
+public:
+    typedef file_store<AddrType> store_t;
+    typedef typename store_t::buf_t buf_t;
+
+private:
+    typedef std::pair<std::string, Entry> item_t;
+
+    store_t m_file;
+    std::vector<item_t> m_items;
+    std::string m_what;  // owner name for error messages
+    bool m_done;
+
+    // prevent copying
+    flat_dir_writer(const flat_dir_writer&);
+    flat_dir_writer& operator=(const flat_dir_writer&);
+
+    static bool less(const item_t& a, const item_t& b) {
+        return a.first < b.first;
+    }
+
+public:
+    flat_dir_writer(const char *a_fname, const char *a_what)
+        : m_file(a_fname), m_what(a_what), m_done(false)
+    {}
+
+    // store for records' data written apart from put()
+    store_t& file() { return m_file; }
+
+    // write a_size bytes aligned to 8 bytes, return their offset,
+    // 0 if there is nothing to write
+    AddrType put(const void *a_data, size_t a_size) {
+        static const char l_zero[8] = {};
+        if (a_size == 0)
+            return 0;
+        uint64_t l_pos = m_file.pos();
+        if (l_pos % 8)
+            m_file.store(buf_t(l_zero, 8 - l_pos % 8));
+        return m_file.store(buf_t(a_data, a_size));
+    }
+
+    // throw if no record can be added under given name
+    void check(const std::string& a_name) const {
+        if (m_done)
+            throw std::runtime_error(m_what + ": already committed");
+        for (size_t i = 0; i < m_items.size(); ++i)
+            if (m_items[i].first == a_name)
+                throw std::invalid_argument(m_what + ": duplicate " +
+                    a_name);
+    }
+
+    void add(const std::string& a_name, const Entry& a_entry) {
+        check(a_name);
+        m_items.push_back(std::make_pair(a_name, a_entry));
+    }
+
+    // write names, directory and header, the file is not valid before
+    void commit(const char (&a_magic)[8], uint32_t a_abi) {
+        if (m_done)
+            throw std::runtime_error(m_what + ": already committed");
+        std::sort(m_items.begin(), m_items.end(), &less);
+        std::vector<Entry> l_dir(m_items.size());
+        for (size_t i = 0; i < m_items.size(); ++i) {
+            const std::string& s = m_items[i].first;
+            l_dir[i] = m_items[i].second;
+            l_dir[i].name = put(s.c_str(), s.size() + 1);
+        }
+        flat_dir_header h;
+        memset(&h, 0, sizeof(h));
+        memcpy(h.magic, a_magic, sizeof(h.magic));
+        h.abi = a_abi;
+        h.count = l_dir.size();
+        h.dir = l_dir.empty() ? 0 :
+            put(&l_dir[0], l_dir.size() * sizeof(Entry));
+        AddrType l_head = put(&h, sizeof(h));
+        m_file.store(buf_t(&l_head, sizeof(l_head)));
+        m_done = true;
+    }
+};
+
+template<typename Entry, typename AddrType = uint64_t>
+class flat_dir_reader {
+    typedef flat_data_store<void, AddrType> store_t;
+    typedef typename mmap_trie_codec_impl<AddrType>::get_root root_finder;
+
+    const char *m_addr;  // address of memory region
+    size_t      m_size;  // size of memory region
+    store_t     m_store; // offset checker
+    std::string m_what;  // owner name for error messages
+    const Entry *m_dir;
+    size_t      m_count;
+
+public:
+    // check header and directory of the image in given memory region
+    flat_dir_reader(const void *a_addr, size_t a_size,
+            const char (&a_magic)[8], uint32_t a_abi, const char *a_what)
+        : m_addr((const char *)a_addr), m_size(a_size)
+        , m_store(m_addr, m_size), m_what(a_what), m_dir(0), m_count(0)
+    {
+        AddrType l_head = root_finder()(m_addr, m_size);
+        const flat_dir_header& h = *array<flat_dir_header>(l_head, 1);
+        if (memcmp(h.magic, a_magic, sizeof(h.magic)))
+            throw std::runtime_error(m_what + ": bad magic");
+        if (h.abi != a_abi)
+            throw std::runtime_error(m_what + ": incompatible format");
+        m_dir = array<Entry>(h.dir, h.count);
+        m_count = h.count;
+        for (size_t i = 0; i < m_count; ++i)
+            string(m_dir[i].name);
+    }
+
+    // array of a_count elements at given offset, null if empty
+    template<typename T>
+    const T *array(uint64_t a_off, uint64_t a_count) const {
+        if (a_count == 0)
+            return 0;
+        const T *p = m_store.template native_pointer<const T>(a_off);
+        if (a_off % sizeof(uint64_t) ||
+                a_count > (m_size - a_off) / sizeof(T))
+            throw std::runtime_error(m_what + ": bad array offset");
+        return p;
+    }
+
+    // NUL terminated string at given offset
+    const char *string(uint64_t a_off) const {
+        const char *s = m_store.template native_pointer<const char>(a_off);
+        if (!memchr(s, 0, m_size - a_off))
+            throw std::runtime_error(m_what + ": bad name");
+        return s;
+    }
+
+    const char *addr() const { return m_addr; }
+    size_t region_size() const { return m_size; }
+
+    // number of entries
+    size_t size() const { return m_count; }
+
+    // entry by index, entries are ordered by name
+    const Entry& entry(size_t i) const {
+        if (i >= m_count)
+            throw std::out_of_range(m_what + ": bad index");
+        return m_dir[i];
+    }
+
+    const char *name(size_t i) const { return m_addr + entry(i).name; }
+
+    // entry index by name or size() if not found
+    size_t find(const char *a_name) const {
+        size_t lo = 0, hi = m_count;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            int c = strcmp(m_addr + m_dir[mid].name, a_name);
+            if (c == 0)
+                return mid;
+            if (c < 0)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return m_count;
+    }
+};
+
+} // namespace detail
+} // namespace container
+} // namespace neutx
+
+#endif // _NEUTX_CONTAINER_DETAIL_FLAT_DIRECTORY_HPP_
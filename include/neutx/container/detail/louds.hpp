@@ -0,0 +1,360 @@
+// ex: ts=4 sw=4 ft=cpp et indentexpr=
+/**
+ * \file
+ * \brief level-order unary degree sequence (LOUDS) trie encoding
+ *
+ * Succinct read-only trie layout: nodes are numbered in breadth-first
+ * order, tree shape is kept as LOUDS bit vector (each node contributes
+ * its degree in unary followed by 0), edge labels are 4-bit digits,
+ * payloads are kept only for nodes having non-zero encoded data and
+ * located via presence bit vector rank.
+ *
+ * Writing side consists of builder_coll_encoder, louds_builder output
+ * store proxy and louds_trie_codec writer, which plug into the usual
+ * ptrie::store_trie() protocol. Reading side is louds_index, used by
+ * neutx::container::mmap_louds_trie.
+ *
+ * \author Dmitriy Kargapolov
+ * \since 19 October 2026
+ *
+ */
+
+/*
+ * Copyright (C) 2026 Dmitriy Kargapolov <dmitriy.kargapolov@gmail.com>
+ * Use, modification and distribution are subject to the Boost Software
+ * License, Version 1.0 (See accompanying file LICENSE_1_0.txt or copy
+ * at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef _NEUTX_CONTAINER_DETAIL_LOUDS_HPP_
+#define _NEUTX_CONTAINER_DETAIL_LOUDS_HPP_
+
+#include <neutx/container/detail/idxmap.hpp>
+#include <neutx/container/detail/default_ptrie_codec.hpp>
+#include <neutx/container/detail/trie_builder.hpp>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <stdexcept>
+
+namespace neutx {
+namespace container {
+namespace detail {
+
+namespace internal {
+
+enum {
+    louds_block_words = 8,   // words per rank directory entry
+    louds_block_bits  = 512, // bits per rank directory entry
+    louds_select_step = 256  // zeros per select directory entry
+};
+
+inline uint64_t louds_load64(const char *p) {
+    uint64_t v; memcpy(&v, p, sizeof(v)); return v;
+}
+
+inline uint32_t louds_load32(const char *p) {
+    uint32_t v; memcpy(&v, p, sizeof(v)); return v;
+}
+
+// position of k-th (0-based) set bit in the word
+inline unsigned louds_select64(uint64_t w, unsigned k) {
+    unsigned b = 0;
+    for (;; b += 8) {
+        unsigned c = __builtin_popcountll((w >> b) & 0xff);
+        if (k < c)
+            break;
+        k -= c;
+    }
+    for (w >>= b; ; w &= w - 1)
+        if (k-- == 0)
+            return b + __builtin_ctzll(w);
+}
+
+// bit vector under construction
+class louds_bits {
+    std::vector<uint64_t> m_words;
+    uint64_t m_size;
+
+public:
+    louds_bits() : m_size(0) {}
+
+    void push(bool bit) {
+        if (m_size % 64 == 0)
+            m_words.push_back(0);
+        if (bit)
+            m_words.back() |= (uint64_t)1 << (m_size % 64);
+        ++m_size;
+    }
+
+    // fill unused bits of the last word
+    void pad(bool bit) {
+        if (bit && m_size % 64 != 0)
+            m_words.back() |= ~(uint64_t)0 << (m_size % 64);
+    }
+
+    uint64_t size() const { return m_size; }
+    const std::vector<uint64_t>& words() const { return m_words; }
+
+    // number of set bits before each block, plus total
+    std::vector<uint64_t> ranks() const {
+        std::vector<uint64_t> ret;
+        uint64_t cnt = 0;
+        for (size_t i = 0; i < m_words.size(); ++i) {
+            if (i % louds_block_words == 0)
+                ret.push_back(cnt);
+            cnt += __builtin_popcountll(m_words[i]);
+        }
+        ret.push_back(cnt);
+        return ret;
+    }
+
+    // block holding each louds_select_step-th zero bit
+    std::vector<uint32_t> select0() const {
+        std::vector<uint32_t> ret;
+        uint64_t cnt = 0;
+        for (size_t i = 0; i < m_words.size(); ++i) {
+            uint64_t z = __builtin_popcountll(~m_words[i]);
+            while (ret.size() * louds_select_step < cnt + z)
+                ret.push_back(i / louds_block_words);
+            cnt += z;
+        }
+        return ret;
+    }
+};
+
+} // namespace internal
+
+// on-disk header, followed by the trie trailer (header address)
+template<typename AddrType>
+struct louds_header {
+    uint64_t nodes;     // number of nodes including root
+    uint64_t nbits;     // number of bits in LOUDS vector
+    uint64_t present;   // number of nodes having payload
+    uint32_t data_size; // size of encoded node data
+    uint32_t reserved;
+    AddrType bits;      // LOUDS bit vector words
+    AddrType ranks;     // LOUDS rank directory
+    AddrType select;    // LOUDS select-0 directory
+    AddrType labels;    // 4-bit edge labels of nodes 1..nodes-1
+    AddrType pbits;     // payload presence bit vector words
+    AddrType pranks;    // presence rank directory
+    AddrType payload;   // payloads of present nodes
+};
+
+/**
+ * \brief output store proxy writing collected trie nodes in LOUDS layout
+ * \tparam Out output store type to write resulting image to
+ */
+template<typename Out>
+class louds_builder : public node_collector<Out> {
+    typedef node_collector<Out> base_t;
+
+public:
+    typedef typename base_t::pointer_t pointer_t;
+    typedef typename base_t::buf_t buf_t;
+
+    template<typename A>
+    louds_builder(const A& a) : base_t(a) {}
+
+    // write breadth-first image of the trie rooted at given node,
+    // return header address
+    pointer_t finish(pointer_t root) {
+        typedef internal::louds_bits bits_t;
+        bits_t bits, pbits;
+        std::vector<uint8_t> labels;
+        std::string payload;
+        std::string zero(this->m_data_size, '\0');
+
+        // super-root
+        bits.push(1); bits.push(0);
+
+        std::deque<uint64_t> queue;
+        queue.push_back(root - 1);
+        uint64_t nodes = 0, present = 0, nlabels = 0;
+        while (!queue.empty()) {
+            uint64_t x = queue.front();
+            queue.pop_front();
+            ++nodes;
+            size_t e = this->edges_end(x);
+            for (size_t i = this->edges_begin(x); i < e; ++i) {
+                bits.push(1);
+                int d = this->m_labels[i] - '0';
+                if (nlabels % 2 == 0)
+                    labels.push_back(d);
+                else
+                    labels.back() |= d << 4;
+                ++nlabels;
+                queue.push_back(this->m_targets[i]);
+            }
+            bits.push(0);
+            const char *data = this->data(x);
+            bool has_data = memcmp(data, zero.data(), zero.size()) != 0;
+            pbits.push(has_data);
+            if (has_data) {
+                payload.append(data, zero.size());
+                ++present;
+            }
+        }
+        bits.pad(1);
+
+        louds_header<pointer_t> h;
+        memset(&h, 0, sizeof(h));
+        h.nodes = nodes;
+        h.nbits = bits.size();
+        h.present = present;
+        h.data_size = this->m_data_size;
+        h.bits = this->store_vector(bits.words());
+        h.ranks = this->store_vector(bits.ranks());
+        h.select = this->store_vector(bits.select0());
+        h.labels = this->store_vector(labels);
+        h.pbits = this->store_vector(pbits.words());
+        h.pranks = this->store_vector(pbits.ranks());
+        h.payload = this->m_out.store(buf_t(payload.data(), payload.size()));
+        return this->m_out.store(buf_t(&h, sizeof(h)));
+    }
+};
+
+// trie writer and root finder
+struct louds_trie_codec {
+    template<typename AddrType>
+    struct bind {
+        typedef builder_trie_writer<AddrType> encoder;
+        typedef typename mmap_trie_codec_impl<AddrType>::get_root root_finder;
+        typedef builder_coll_encoder<AddrType> coll_encoder;
+        typedef void builder_tag;
+        template<typename Out>
+        struct store { typedef louds_builder<Out> type; };
+    };
+};
+
+/**
+ * \brief read-only view of LOUDS trie image
+ *
+ * Node is identified by its breadth-first number, root is 0.
+ */
+template<typename AddrType>
+class louds_index {
+    typedef internal::louds_bits bits_t;
+    enum {
+        bw = internal::louds_block_words,
+        bb = internal::louds_block_bits,
+        ss = internal::louds_select_step
+    };
+
+    uint64_t m_nodes;
+    uint64_t m_nbits;
+    size_t m_data_size;
+    const char *m_bits, *m_ranks, *m_select, *m_labels;
+    const char *m_pbits, *m_pranks, *m_payload;
+
+    const char *region(const char *base, size_t size, AddrType off,
+            uint64_t len) const {
+        if (len == 0)
+            return 0;
+        if (off == 0 || off > size || len > size - off)
+            throw std::invalid_argument("louds: bad offset");
+        return base + off;
+    }
+
+    uint64_t word(const char *v, uint64_t i) const {
+        return internal::louds_load64(v + i * sizeof(uint64_t));
+    }
+
+    // number of zeros before given position of LOUDS vector
+    uint64_t select0(uint64_t k) const {
+        uint64_t b = internal::louds_load32(m_select + k / ss *
+            sizeof(uint32_t));
+        uint64_t nblocks = (m_nbits + bb - 1) / bb;
+        while (b + 1 < nblocks && (b + 1) * bb - word(m_ranks, b + 1) <= k)
+            ++b;
+        k -= b * bb - word(m_ranks, b);
+        for (uint64_t w = b * bw; ; ++w) {
+            uint64_t x = ~word(m_bits, w);
+            unsigned z = __builtin_popcountll(x);
+            if (k < z)
+                return w * 64 + internal::louds_select64(x, k);
+            k -= z;
+        }
+    }
+
+public:
+    louds_index(const void *a_addr, size_t a_size, AddrType a_head) {
+        const char *base = (const char *)a_addr;
+        if (a_head == 0 || a_head > a_size ||
+                sizeof(louds_header<AddrType>) > a_size - a_head)
+            throw std::invalid_argument("louds: bad header offset");
+        louds_header<AddrType> h;
+        memcpy(&h, base + a_head, sizeof(h));
+        m_nodes = h.nodes;
+        m_nbits = h.nbits;
+        m_data_size = h.data_size;
+        uint64_t nwords = (h.nbits + 63) / 64;
+        uint64_t nblocks = (nwords + bw - 1) / bw;
+        uint64_t pwords = (h.nodes + 63) / 64;
+        uint64_t pblocks = (pwords + bw - 1) / bw;
+        m_bits = region(base, a_size, h.bits, nwords * 8);
+        m_ranks = region(base, a_size, h.ranks, (nblocks + 1) * 8);
+        m_select = region(base, a_size, h.select,
+            (h.nodes + ss) / ss * sizeof(uint32_t));
+        m_labels = region(base, a_size, h.labels, h.nodes / 2);
+        m_pbits = region(base, a_size, h.pbits, pwords * 8);
+        m_pranks = region(base, a_size, h.pranks, (pblocks + 1) * 8);
+        m_payload = region(base, a_size, h.payload,
+            h.present * h.data_size);
+    }
+
+    uint64_t size() const { return m_nodes; }
+    size_t data_size() const { return m_data_size; }
+
+    // children of node x are nodes [first, first + degree)
+    unsigned children(uint64_t x, uint64_t& first) const {
+        uint64_t b = select0(x);
+        first = b - x;
+        return select0(x + 1) - b - 1;
+    }
+
+    // edge label of node x > 0
+    char label(uint64_t x) const {
+        uint8_t v = (uint8_t)m_labels[(x - 1) / 2];
+        return '0' + ((x - 1) % 2 ? v >> 4 : v & 0x0f);
+    }
+
+    // encoded data of node x or 0 if node has no payload
+    const char *data(uint64_t x) const {
+        uint64_t w = word(m_pbits, x / 64);
+        uint64_t bit = (uint64_t)1 << (x % 64);
+        if ((w & bit) == 0)
+            return 0;
+        uint64_t r = word(m_pranks, x / bb);
+        for (uint64_t i = x / bb * bw; i < x / 64; ++i)
+            r += __builtin_popcountll(word(m_pbits, i));
+        r += __builtin_popcountll(w & (bit - 1));
+        return m_payload + r * m_data_size;
+    }
+
+    // child of node x with given label; if missing, nearest child with
+    // lesser label is returned setting left flag, or false if none
+    bool child(uint64_t x, char sym, uint64_t& ret, bool& left) const {
+        uint64_t first;
+        unsigned n = children(x, first);
+        left = false;
+        for (unsigned i = n; i > 0; --i) {
+            char c = label(first + i - 1);
+            if (c <= sym) {
+                ret = first + i - 1;
+                left = c != sym;
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+} // namespace detail
+} // namespace container
+} // namespace neutx
+
+#endif // _NEUTX_CONTAINER_DETAIL_LOUDS_HPP_
@@ -45,6 +45,9 @@ public:
     typedef typename Coll::template rebind<ptr_t>::other sarray_t;
     typedef typename sarray_t::symbol_t symbol_t;
 
+    // node has no suffix links, may be shared by several parents
+    static const bool has_suffix_links = false;
+
     // constructor
     pnode() {}
 
@@ -68,6 +68,9 @@ public:
     // metadata to support cross-links writing
     typedef internal::meta<Offset> meta_t;
 
+    // suffix links assume every node has exactly one parent
+    static const bool has_suffix_links = true;
+
     // constructor
     pnode_ss() : m_suffix(store_t::null), m_shift(0) {}
 
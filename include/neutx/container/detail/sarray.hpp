@@ -88,6 +88,14 @@ public:
         IdxMap::foreach(m_mask, k2kv<Data, F>(m_array, f));
     }
 
+    // number of elements, one mask bit per element
+    size_t size() const { return __builtin_popcountll(m_mask); }
+
+    // bytes of elements following the mask
+    size_t mem_bytes() const { return size() * sizeof(Data); }
+
+    size_t spare_bytes() const { return 0; }
+
     // collection writer preparing data for reading by sarray
     //
     struct encoder {
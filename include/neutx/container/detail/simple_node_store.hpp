@@ -46,6 +46,12 @@ public:
     // this store provides allocate/deallocate methods
     static const bool dynamic = true;
 
+    // trie can't be read while updated
+    static const bool concurrent = false;
+
+    // no reader registration needed
+    struct read_guard { read_guard(const simple_node_store&) {} };
+
     // abstract node pointer
     typedef void* pointer_t;
 
@@ -90,6 +90,17 @@ public:
         return m_array.at(l_index);
     }
 
+    // number of elements
+    size_t size() const { return m_array.size(); }
+
+    // bytes allocated for elements
+    size_t mem_bytes() const { return m_array.capacity() * sizeof(Data); }
+
+    // bytes allocated but not used
+    size_t spare_bytes() const {
+        return (m_array.capacity() - m_array.size()) * sizeof(Data);
+    }
+
     // call functor for each value
     template<typename F> void foreach_value(F f) {
         BOOST_FOREACH(const Data& data, m_array) f(data);
@@ -0,0 +1,244 @@
+// ex: ts=4 sw=4 ft=cpp et indentexpr=
+/**
+ * \file
+ * \brief in-memory collector of exported trie nodes
+ *
+ * Base for writers of trie layouts which can't be produced node by node
+ * in the depth-first order of ptrie::store_trie(), e.g. breadth-first
+ * LOUDS or double-array layouts. Plugs into the usual export protocol
+ * as output store proxy accompanied by builder_coll_encoder.
+ *
+ * \author Dmitriy Kargapolov
+ * \since 19 October 2026
+ *
+ */
+
+/*
+ * Copyright (C) 2026 Dmitriy Kargapolov <dmitriy.kargapolov@gmail.com>
+ * Use, modification and distribution are subject to the Boost Software
+ * License, Version 1.0 (See accompanying file LICENSE_1_0.txt or copy
+ * at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef _NEUTX_CONTAINER_DETAIL_TRIE_BUILDER_HPP_
+#define _NEUTX_CONTAINER_DETAIL_TRIE_BUILDER_HPP_
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+namespace neutx {
+namespace container {
+namespace detail {
+
+/**
+ * \brief output store proxy collecting trie nodes
+ * \tparam Out output store type to write resulting image to
+ *
+ * Payload chunks written by data encoders are passed through to the
+ * underlying store, node records are kept in memory for the derived
+ * class to lay out. Node record is recognized as the store() call
+ * following builder_coll_encoder::store(). Node address is its
+ * post-order number plus one.
+ */
+template<typename Out>
+class node_collector {
+public:
+    typedef typename Out::pointer_t pointer_t;
+    typedef std::pair<const void *, size_t> buf_t;
+    typedef std::vector<std::pair<char, uint64_t> > children_t;
+
+    template<typename A>
+    node_collector(const A& a)
+        : m_out(a), m_data_size(0), m_links(false), m_pending(false)
+    {}
+
+    pointer_t null() const { return m_out.null(); }
+
+    // called by builder_coll_encoder: next store() is a node record
+    void children(const children_t& a) {
+        m_children = a;
+        m_pending = true;
+    }
+
+    pointer_t store(const buf_t& b) {
+        if (m_pending)
+            return add_node(b);
+        return m_out.store(b);
+    }
+
+    // node record |data|children| or data chunk
+    pointer_t store(const buf_t& b1, const buf_t& b2) {
+        if (m_pending)
+            return add_node(b1);
+        return m_out.store(b1, b2);
+    }
+
+    pointer_t store(const buf_t& b1, const buf_t& b2, const buf_t& b3) {
+        if (m_pending)
+            throw std::invalid_argument("builder: unsupported node layout");
+        return m_out.store(b1, b2, b3);
+    }
+
+    // node record |data|suffix|shift|children| or data chunk
+    pointer_t store(const buf_t& b1, const buf_t& b2, const buf_t& b3,
+            const buf_t& b4) {
+        if (!m_pending)
+            return m_out.store(b1, b2, b3, b4);
+        if (b3.second != sizeof(uint8_t))
+            throw std::invalid_argument("builder: bad shift field");
+        m_links = true;
+        pointer_t ret = add_node(b1);
+        m_shift.back() = *(const uint8_t *)b3.first;
+        return ret;
+    }
+
+    // suffix link of the node written by pnode_ss::store_links()
+    void store_at(pointer_t addr, pointer_t off, const buf_t& buff) {
+        if (addr == 0 || addr > m_first.size() || off != m_data_size ||
+                buff.second != sizeof(pointer_t))
+            throw std::invalid_argument("builder: bad link position");
+        pointer_t link;
+        memcpy(&link, buff.first, sizeof(link));
+        m_suffix[addr - 1] = link;
+    }
+
+protected:
+    Out m_out;
+
+    std::string m_data;              // node data, post-order
+    std::vector<uint64_t> m_first;   // first edge of node
+    std::vector<uint64_t> m_suffix;  // suffix node address or 0
+    std::vector<uint8_t> m_shift;    // suffix distance
+    std::vector<char> m_labels;      // edge labels
+    std::vector<uint64_t> m_targets; // edge targets, post-order number
+    size_t m_data_size;              // size of encoded node data
+    bool m_links;                    // nodes have suffix links
+
+    // number of nodes collected
+    size_t size() const { return m_first.size(); }
+
+    // edges of node x are [edges_begin(x), edges_end(x))
+    size_t edges_begin(uint64_t x) const { return m_first[x]; }
+    size_t edges_end(uint64_t x) const {
+        return x + 1 < m_first.size() ? m_first[x + 1] : m_labels.size();
+    }
+
+    // encoded data of node x
+    const char *data(uint64_t x) const {
+        return m_data.data() + x * m_data_size;
+    }
+
+    template<typename T>
+    pointer_t store_vector(const std::vector<T>& v) {
+        return v.empty() ? m_out.null() :
+            m_out.store(buf_t(&v[0], v.size() * sizeof(T)));
+    }
+
+    // pad output so that next chunk starts at multiple of 8
+    void align() {
+        static const char zero[8] = {};
+        pointer_t pos = m_out.store(buf_t(zero, 1)) + 1;
+        if (pos % 8 != 0)
+            m_out.store(buf_t(zero, 8 - pos % 8));
+    }
+
+private:
+    bool m_pending;
+    children_t m_children;
+
+    pointer_t add_node(const buf_t& data) {
+        m_pending = false;
+        if (m_first.empty())
+            m_data_size = data.second;
+        else if (data.second != m_data_size)
+            throw std::invalid_argument("builder: variable data size");
+        m_data.append((const char *)data.first, data.second);
+        m_first.push_back(m_labels.size());
+        m_suffix.push_back(0);
+        m_shift.push_back(0);
+        for (size_t i = 0; i < m_children.size(); ++i) {
+            m_labels.push_back(m_children[i].first);
+            m_targets.push_back(m_children[i].second - 1);
+        }
+        return m_first.size();
+    }
+};
+
+// collection writer registering children in node_collector
+//
+template<typename AddrType>
+class builder_coll_encoder {
+    typedef std::pair<const void *, size_t> buf_t;
+    std::vector<std::pair<char, uint64_t> > m_children;
+    buf_t m_buf;
+
+    template<typename F>
+    struct ftor {
+        ftor(builder_coll_encoder& e, F& f) : e_(e), f_(f) {}
+        builder_coll_encoder& e_; F& f_;
+        template<typename K, typename V>
+        void operator()(K k, V v) {
+            int i = k - '0';
+            if (i < 0 || i > 9)
+                throw std::out_of_range("element key");
+            e_.m_children.push_back(std::make_pair(k, f_(v)));
+        }
+    };
+
+public:
+    // encoder always initialized with parent state
+    template<typename T> builder_coll_encoder(T&) : m_buf(0, 0) {}
+
+    template<typename T, typename S, typename F, typename O>
+    void store(const T& coll, const S&, F func, O& out) {
+        coll.foreach_keyval(ftor<F>(*this, func));
+        out.children(m_children);
+    }
+
+    const buf_t& buff() const { return m_buf; }
+};
+
+// trie writer completing node_collector based store
+//
+template<typename AddrType>
+class builder_trie_writer {
+    typedef std::pair<const void *, size_t> buf_t;
+    AddrType head;
+    buf_t buf;
+
+public:
+    template<typename T> builder_trie_writer(T&) {}
+
+    template<typename F, typename S>
+    void store(F f, S& out) {
+        // collect trie nodes, write the image, get header address
+        head = out.finish(f());
+        buf.first = &head;
+        buf.second = sizeof(head);
+    }
+
+    const buf_t& buff() const { return buf; }
+};
+
+// export layout of trie codec binding: collection encoder and output
+// store type, given defaults unless codec is node_collector based
+template<typename Bind, typename Coll, typename Out, typename = void>
+struct trie_layout {
+    typedef Coll coll_encoder;
+    typedef Out store;
+};
+
+template<typename Bind, typename Coll, typename Out>
+struct trie_layout<Bind, Coll, Out, typename Bind::builder_tag> {
+    typedef typename Bind::coll_encoder coll_encoder;
+    typedef typename Bind::template store<Out>::type store;
+};
+
+} // namespace detail
+} // namespace container
+} // namespace neutx
+
+#endif // _NEUTX_CONTAINER_DETAIL_TRIE_BUILDER_HPP_
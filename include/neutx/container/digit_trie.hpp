@@ -28,8 +28,13 @@
 #include <neutx/container/detail/pnode_ro.hpp>
 #include <neutx/container/detail/pnode_ss_ro.hpp>
 #include <neutx/container/detail/default_ptrie_codec.hpp>
+#include <neutx/container/detail/dedup_codec.hpp>
+#include <neutx/container/detail/louds.hpp>
+#include <neutx/container/detail/double_array.hpp>
 #include <neutx/container/ptrie.hpp>
 #include <neutx/container/mmap_ptrie.hpp>
+#include <neutx/container/mmap_louds_trie.hpp>
+#include <neutx/container/mmap_da_trie.hpp>
 
 namespace neutx {
 namespace container {
@@ -84,6 +89,35 @@ struct digit_node<Data, Trie_AhoCorasickExport, AddrType> {
             dt::sarray<> > type_ro;
 };
 
+// mmap-ed trie type by trie codec
+template<typename Data, trie_model Model, typename AddrType,
+    typename TrieCodec>
+struct digit_reader {
+    typedef typename TrieCodec::template bind<AddrType>::root_finder rf;
+    // trie read-only (mmap-ed) node type
+    typedef typename digit_node<Data, Model, AddrType>::type_ro node_type;
+    // mmap-ed trie type
+    typedef ct::mmap_ptrie<node_type, rf> type;
+};
+
+template<typename Data, trie_model Model, typename AddrType>
+struct digit_reader<Data, Model, AddrType, dt::louds_trie_codec> {
+    typedef typename dt::louds_trie_codec::bind<AddrType>::root_finder rf;
+    typedef ct::mmap_louds_trie<Data, rf, ct::ptrie_traits_default,
+        AddrType> type;
+    // trie node handle type
+    typedef typename type::node_t node_type;
+};
+
+template<typename Data, trie_model Model, typename AddrType>
+struct digit_reader<Data, Model, AddrType, dt::da_trie_codec> {
+    typedef typename dt::da_trie_codec::bind<AddrType>::root_finder rf;
+    typedef ct::mmap_da_trie<Data, rf, ct::ptrie_traits_default,
+        AddrType> type;
+    // trie node handle type
+    typedef typename type::node_t node_type;
+};
+
 }
 
 template<
@@ -104,20 +138,40 @@ struct digit_trie {
     typedef typename trie_type::position_t position_type;
 
     // encoder traits
-    template<typename DataCodec, typename TrieCodec = dt::mmap_trie_codec>
+    template<
+        typename DataCodec, typename TrieCodec = dt::mmap_trie_codec,
+        typename Out = dt::file_store<AddrType>
+    >
     struct encoder_type {
 
+        // export layout, breadth-first codecs (dt::louds_trie_codec,
+        // dt::da_trie_codec) bring own collection encoder and store proxy;
+        // Out is the output store, e.g. trie_pack_writer::store_type
+        typedef dt::trie_layout<
+            typename TrieCodec::template bind<AddrType>,
+            typename dt::sarray<AddrType>::encoder, Out> layout;
+
         // encoder protocol types
         typedef AddrType addr_type;
         typedef typename DataCodec::template bind<addr_type>::encoder
             data_encoder;
-        typedef typename dt::sarray<addr_type>::encoder coll_encoder;
+        typedef typename layout::coll_encoder coll_encoder;
 
         typedef typename TrieCodec::template bind<addr_type>::encoder
             trie_encoder;
 
+        // state shared by data encoders during export (e.g. payload
+        // dictionary of dt::dedup_codec), use one encoder object per export
+        typedef typename dt::encoder_state<data_encoder>::type
+            data_state_type;
+
+        data_state_type& data_state() { return m_data_state; }
+
         // not part of encoder protocol - placed here for convenience only
-        typedef dt::file_store<addr_type> file_store;
+        typedef typename layout::store file_store;
+
+    private:
+        data_state_type m_data_state;
     };
 };
 
@@ -133,15 +187,18 @@ struct digit_mmap_trie {
     // node payload type
     typedef typename DataCodec::template bind<addr_type>::data_type data_type;
 
+    // reader selected by trie codec
+    typedef digit_reader<data_type, Model, addr_type, TrieCodec> reader;
+
     // trie node type
-    typedef typename digit_node<data_type, Model, addr_type>::type_ro node_type;
+    typedef typename reader::node_type node_type;
 
     // root node finder
     typedef typename TrieCodec::template bind<addr_type>::root_finder
         root_finder;
 
     // mmap-ed trie type
-    typedef ct::mmap_ptrie<node_type, root_finder> trie_type;
+    typedef typename reader::type trie_type;
 
     // concrete trie store type
     typedef typename trie_type::store_t store_type;
@@ -150,7 +207,6 @@ struct digit_mmap_trie {
     typedef typename trie_type::position_t position_type;
 };
 
-
 } // namespace container
 } // namespace neutx
 
@@ -0,0 +1,239 @@
+// ex: ts=4 sw=4 ft=cpp et indentexpr=
+/**
+ * \file
+ * \brief double-array persistent trie in memory mapped file
+ *
+ * Read-only counterpart of ptrie exported with detail::da_trie_codec,
+ * providing the same fold(), fold_full(), left_bound() and foreach()
+ * interface as neutx::container::mmap_ptrie.
+ *
+ * \author Dmitriy Kargapolov
+ * \since 19 October 2026
+ *
+ */
+
+/*
+ * Copyright (C) 2026 Dmitriy Kargapolov <dmitriy.kargapolov@gmail.com>
+ * Use, modification and distribution are subject to the Boost Software
+ * License, Version 1.0 (See accompanying file LICENSE_1_0.txt or copy
+ * at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef _NEUTX_CONTAINER_MMAP_DA_TRIE_HPP_
+#define _NEUTX_CONTAINER_MMAP_DA_TRIE_HPP_
+
+#include <neutx/container/ptrie.hpp>
+#include <neutx/container/detail/double_array.hpp>
+#include <neutx/container/detail/flat_data_store.hpp>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+namespace neutx {
+namespace container {
+
+namespace { namespace bip = boost::interprocess; }
+
+template <typename Data, typename RootF,
+          typename Traits = ptrie_traits_default, typename AddrType = uint32_t>
+class mmap_da_trie {
+public:
+    typedef detail::flat_data_store<void, AddrType> store_t;
+    typedef typename store_t::pointer_t ptr_t;
+    typedef detail::idxmap<1>::symbol_t symbol_t;
+    typedef Traits traits_t;
+    typedef typename traits_t::position_type position_t;
+    typedef detail::da_index<AddrType> index_t;
+
+    // node handle, behaves as pointer to node as well
+    class node_t {
+        const index_t *m_index;
+        uint32_t m_state;
+
+    public:
+        node_t() : m_index(0), m_state(0) {}
+        node_t(const index_t *a_index, uint32_t a_state)
+            : m_index(a_index), m_state(a_state) {}
+
+        // node data payload
+        const Data& data() const {
+            return *(const Data *)m_index->data(m_state);
+        }
+
+        // double-array state of the node, root is detail::da_root
+        uint32_t id() const { return m_state; }
+
+        const node_t *operator->() const { return this; }
+        const node_t& operator*() const { return *this; }
+        explicit operator bool() const { return m_index != 0; }
+    };
+
+protected:
+    bip::file_mapping  m_fmap;
+    bip::mapped_region m_reg;
+
+    const void *m_addr;  // address of memory region
+    size_t      m_size;  // size of memory region
+    store_t     m_store; // read-only data store
+    RootF       m_head;  // header finder functor
+    index_t     m_index; // trie structure
+
+    const Data& data(uint32_t s) const {
+        return *(const Data *)m_index.data(s);
+    }
+
+public:
+    mmap_da_trie(const char *fname, const RootF& root = RootF())
+        : m_fmap(fname, bip::read_only)
+        , m_reg(m_fmap, bip::read_only)
+        , m_addr(m_reg.get_address())
+        , m_size(m_reg.get_size())
+        , m_store(m_addr, m_size)
+        , m_head(root)
+        , m_index(m_addr, m_size, m_head(m_addr, m_size))
+    {
+        if (m_index.data_size() != sizeof(Data))
+            throw std::invalid_argument("mmap_da_trie: data size mismatch");
+        m_reg.advise(bip::mapped_region::advice_willneed);
+    }
+
+    // view of trie image in memory region kept by the caller,
+    // e.g. a trie of trie_pack
+    mmap_da_trie(const void *addr, size_t size, const RootF& root = RootF())
+        : m_addr(addr)
+        , m_size(size)
+        , m_store(m_addr, m_size)
+        , m_head(root)
+        , m_index(m_addr, m_size, m_head(m_addr, m_size))
+    {
+        if (m_index.data_size() != sizeof(Data))
+            throw std::invalid_argument("mmap_da_trie: data size mismatch");
+    }
+
+    // header/root-finder getter
+    const RootF& head() const { return m_head; }
+
+    // access to data store
+    const store_t& store() const { return m_store; }
+
+    // number of double-array units
+    uint64_t size() const { return m_index.size(); }
+
+    // fold through trie nodes following key components
+    template <typename Key, typename A, typename F>
+    void fold(const Key& key, A& acc, F proc) const {
+        typename Traits::template cursor<Key>::type cursor(key);
+        uint32_t node = detail::da_root;
+        position_t k = 0;
+        bool has_data = cursor.has_data();
+        while (has_data) {
+            node = m_index.child(node, cursor.get_data());
+            if (!node)
+                break;
+            cursor.next();
+            has_data = cursor.has_data();
+            if (!proc(acc, data(node), m_store, ++k, has_data))
+                break;
+        }
+    }
+
+    // fold through trie nodes following key components and suffix links
+    template <typename Key, typename A, typename F>
+    void fold_full(const Key& key, A& acc, F proc) const {
+        if (!m_index.has_links())
+            throw std::runtime_error("mmap_da_trie: no suffix links");
+        typename Traits::template cursor<Key>::type cursor(key);
+        uint32_t node = detail::da_root;
+        position_t end = 0;
+
+        position_t begin = 0;
+        while (cursor.has_data()) {
+
+            // get child node
+            uint32_t next_node = m_index.child(node, cursor.get_data());
+            if (next_node) {
+                // switch to child node
+                node = next_node;
+                cursor.next(); ++end;
+
+                // process child node and all it's suffixes
+                position_t start = begin;
+                while ( proc(acc, data(next_node), m_store, start, end,
+                            cursor.has_data()) ) {
+                    // get next suffix
+                    const detail::da_link& link = m_index.link(next_node);
+                    if (link.suffix == 0)
+                        break;
+                    start += link.shift;
+                    next_node = link.suffix;
+                }
+                continue;
+            }
+
+            // get suffix node
+            const detail::da_link& link = m_index.link(node);
+            if (link.suffix == 0) {
+                // no child, no suffix
+                if (node == detail::da_root) {
+                    cursor.next(); ++begin; ++end;
+                } else {
+                    node = detail::da_root; begin = end;
+                }
+            } else {
+                // else switch to suffix node
+                begin += link.shift;
+                node = link.suffix;
+            }
+        }
+    }
+
+    // traverse const trie
+    template<dir_t D, typename Key, typename F>
+    void foreach(F functor) const {
+        Key key;
+        foreach<D>(detail::da_root, key, functor);
+    }
+
+    // find a node exactly matching given key or closest left node at the
+    // level where current symbol node couldn't be matched otherwise
+    // return a pair of flag "left node used" and node handle
+    template<typename Key>
+    std::pair<bool, node_t> left_bound(const Key& key) const {
+        typename traits_t::template cursor<Key>::type cursor(key);
+        uint32_t node = detail::da_root;
+        bool left = false;
+        while (cursor.has_data()) {
+            uint32_t next = m_index.child_left(node, cursor.get_data(), left);
+            if (!next)
+                break;
+            node = next;
+            if (left)
+                break;
+            cursor.next();
+        }
+        return std::make_pair(left, node_t(&m_index, node));
+    }
+
+private:
+    template<dir_t D, typename Key, typename F>
+    void foreach(uint32_t a_node, Key& a_key, F& f) const {
+        node_t node(&m_index, a_node);
+        if (D == down)
+            f(a_key, node, m_store);
+        for (symbol_t c = '0'; c <= '9'; ++c) {
+            uint32_t next = m_index.child(a_node, c);
+            if (!next)
+                continue;
+            a_key.push_back(c);
+            foreach<D>(next, a_key, f);
+            a_key.erase(a_key.end() - 1);
+        }
+        if (D == up)
+            f(a_key, node, m_store);
+    }
+};
+
+} // namespace container
+} // namespace neutx
+
+#endif // _NEUTX_CONTAINER_MMAP_DA_TRIE_HPP_
@@ -0,0 +1,186 @@
+// ex: ts=4 sw=4 ft=cpp et indentexpr=
+/**
+ * \file
+ * \brief succinct (LOUDS) persistent trie in memory mapped file
+ *
+ * Read-only counterpart of ptrie exported with detail::louds_trie_codec,
+ * providing the same fold(), left_bound() and foreach() interface as
+ * neutx::container::mmap_ptrie at the cost of rank/select operations
+ * on every step.
+ *
+ * \author Dmitriy Kargapolov
+ * \since 19 October 2026
+ *
+ */
+
+/*
+ * Copyright (C) 2026 Dmitriy Kargapolov <dmitriy.kargapolov@gmail.com>
+ * Use, modification and distribution are subject to the Boost Software
+ * License, Version 1.0 (See accompanying file LICENSE_1_0.txt or copy
+ * at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef _NEUTX_CONTAINER_MMAP_LOUDS_TRIE_HPP_
+#define _NEUTX_CONTAINER_MMAP_LOUDS_TRIE_HPP_
+
+#include <neutx/container/ptrie.hpp>
+#include <neutx/container/detail/louds.hpp>
+#include <neutx/container/detail/flat_data_store.hpp>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+namespace neutx {
+namespace container {
+
+namespace { namespace bip = boost::interprocess; }
+
+template <typename Data, typename RootF,
+          typename Traits = ptrie_traits_default, typename AddrType = uint32_t>
+class mmap_louds_trie {
+public:
+    typedef detail::flat_data_store<void, AddrType> store_t;
+    typedef typename store_t::pointer_t ptr_t;
+    typedef detail::idxmap<1>::symbol_t symbol_t;
+    typedef Traits traits_t;
+    typedef typename traits_t::position_type position_t;
+    typedef detail::louds_index<AddrType> index_t;
+
+    // node handle, behaves as pointer to node as well
+    class node_t {
+        const index_t *m_index;
+        uint64_t m_id;
+
+    public:
+        node_t() : m_index(0), m_id(0) {}
+        node_t(const index_t *a_index, uint64_t a_id)
+            : m_index(a_index), m_id(a_id) {}
+
+        // node data payload, value-initialized if node has no payload
+        const Data& data() const {
+            static const Data zero = Data();
+            const char *p = m_index->data(m_id);
+            return p ? *(const Data *)p : zero;
+        }
+
+        // breadth-first number of the node, root is 0
+        uint64_t id() const { return m_id; }
+
+        const node_t *operator->() const { return this; }
+        const node_t& operator*() const { return *this; }
+        explicit operator bool() const { return m_index != 0; }
+    };
+
+protected:
+    bip::file_mapping  m_fmap;
+    bip::mapped_region m_reg;
+
+    const void *m_addr;  // address of memory region
+    size_t      m_size;  // size of memory region
+    store_t     m_store; // read-only data store
+    RootF       m_head;  // header finder functor
+    index_t     m_index; // trie structure
+
+public:
+    mmap_louds_trie(const char *fname, const RootF& root = RootF())
+        : m_fmap(fname, bip::read_only)
+        , m_reg(m_fmap, bip::read_only)
+        , m_addr(m_reg.get_address())
+        , m_size(m_reg.get_size())
+        , m_store(m_addr, m_size)
+        , m_head(root)
+        , m_index(m_addr, m_size, m_head(m_addr, m_size))
+    {
+        if (m_index.data_size() != sizeof(Data) && m_index.data_size() != 0)
+            throw std::invalid_argument("louds: data size mismatch");
+    }
+
+    // view of trie image in memory region kept by the caller,
+    // e.g. a trie of trie_pack
+    mmap_louds_trie(const void *addr, size_t size,
+            const RootF& root = RootF())
+        : m_addr(addr)
+        , m_size(size)
+        , m_store(m_addr, m_size)
+        , m_head(root)
+        , m_index(m_addr, m_size, m_head(m_addr, m_size))
+    {
+        if (m_index.data_size() != sizeof(Data) && m_index.data_size() != 0)
+            throw std::invalid_argument("louds: data size mismatch");
+    }
+
+    // header/root-finder getter
+    const RootF& head() const { return m_head; }
+
+    // access to data store
+    const store_t& store() const { return m_store; }
+
+    // number of nodes
+    uint64_t size() const { return m_index.size(); }
+
+    // fold through trie nodes following key components
+    template <typename Key, typename A, typename F>
+    void fold(const Key& key, A& acc, F proc) const {
+        typename Traits::template cursor<Key>::type cursor(key);
+        uint64_t node = 0;
+        position_t k = 0;
+        bool has_data = cursor.has_data(), left;
+        while (has_data) {
+            if (!m_index.child(node, cursor.get_data(), node, left) || left)
+                break;
+            cursor.next();
+            has_data = cursor.has_data();
+            if (!proc(acc, node_t(&m_index, node).data(), m_store, ++k,
+                    has_data))
+                break;
+        }
+    }
+
+    // traverse const trie
+    template<dir_t D, typename Key, typename F>
+    void foreach(F functor) const {
+        Key key;
+        foreach<D>(0, key, functor);
+    }
+
+    // find a node exactly matching given key or closest left node at the
+    // level where current symbol node couldn't be matched otherwise
+    // return a pair of flag "left node used" and node handle
+    template<typename Key>
+    std::pair<bool, node_t> left_bound(const Key& key) const {
+        typename traits_t::template cursor<Key>::type cursor(key);
+        uint64_t node = 0, next;
+        bool left = false;
+        while (cursor.has_data()) {
+            if (!m_index.child(node, cursor.get_data(), next, left))
+                break;
+            node = next;
+            if (left)
+                break;
+            cursor.next();
+        }
+        return std::make_pair(left, node_t(&m_index, node));
+    }
+
+private:
+    template<dir_t D, typename Key, typename F>
+    void foreach(uint64_t a_node, Key& a_key, F& f) const {
+        node_t node(&m_index, a_node);
+        if (D == down)
+            f(a_key, node, m_store);
+        uint64_t first;
+        unsigned n = m_index.children(a_node, first);
+        for (unsigned i = 0; i < n; ++i) {
+            a_key.push_back(m_index.label(first + i));
+            foreach<D>(first + i, a_key, f);
+            a_key.erase(a_key.end() - 1);
+        }
+        if (D == up)
+            f(a_key, node, m_store);
+    }
+};
+
+} // namespace container
+} // namespace neutx
+
+#endif // _NEUTX_CONTAINER_MMAP_LOUDS_TRIE_HPP_
@@ -19,9 +19,12 @@
 #define _NEUTX_CONTAINER_MMAP_PTRIE_HPP_
 
 #include <neutx/container/ptrie.hpp>
+#include <neutx/container/trie_stats.hpp>
 
 #include <boost/interprocess/file_mapping.hpp>
 #include <boost/interprocess/mapped_region.hpp>
+#include <memory>
+#include <utility>
 
 namespace neutx {
 namespace container {
@@ -43,6 +46,7 @@ public:
 protected:
     bip::file_mapping  m_fmap;
     bip::mapped_region m_reg;
+    std::shared_ptr<const void> m_owner; // keeps caller's region alive
 
     const void *m_addr;  // address of memory region
     size_t      m_size;  // size of memory region
@@ -65,12 +69,58 @@ public:
         m_reg.advise(bip::mapped_region::advice_willneed);
     }
 
+    // view of trie image in memory region kept by the caller,
+    // e.g. a trie of trie_pack
+    mmap_ptrie(const void *addr, size_t size, const RootF& root = RootF())
+        : m_addr(addr)
+        , m_size(size)
+        , m_store(m_addr, m_size)
+        , m_head(root)
+        , m_root(m_head(m_addr, m_size))
+        , m_trie(m_store, m_root)
+    {}
+
+    // trie image in memory shared with the caller, e.g. a buffer
+    // received from the network, released with its last owner
+    mmap_ptrie(const std::shared_ptr<const void>& owner, size_t size,
+            const RootF& root = RootF())
+        : m_owner(owner)
+        , m_addr(m_owner.get())
+        , m_size(size)
+        , m_store(m_addr, m_size)
+        , m_head(root)
+        , m_root(m_head(m_addr, m_size))
+        , m_trie(m_store, m_root)
+    {}
+
+    // trie image in region mapped by the caller, e.g. from shared memory
+    // object, anonymous memory or memfd, the mapping is taken over
+    mmap_ptrie(bip::mapped_region&& reg, const RootF& root = RootF())
+        : m_reg(std::move(reg))
+        , m_addr(m_reg.get_address())
+        , m_size(m_reg.get_size())
+        , m_store(m_addr, m_size)
+        , m_head(root)
+        , m_root(m_head(m_addr, m_size))
+        , m_trie(m_store, m_root)
+    {}
+
     // header/root-finder getter
     const RootF& head() const { return m_head; }
 
     // access to node store
     const store_t& store() const { return m_store; }
 
+    // memory footprint, see ptrie::stats(), with the size of the image
+    // region, mapped or owned by the caller, and its part resident
+    // in memory
+    trie_stats stats() const {
+        trie_stats l_stats = m_trie.stats();
+        l_stats.mapped_bytes = m_size;
+        l_stats.resident_bytes = detail::resident_bytes(m_addr, m_size);
+        return l_stats;
+    }
+
     // fold through trie nodes following key components
     template <typename Key, typename A, typename F>
     void fold(const Key& key, A& acc, F proc) const {
@@ -86,7 +136,7 @@ public:
     // traverse const trie
     template<dir_t D, typename Key, typename F>
     void foreach(F functor) const {
-        m_trie.foreach<D, Key, F>(functor);
+        m_trie.template foreach<D, Key, F>(functor);
     }
 
     // find a node exactly matching given key or closest left node at the
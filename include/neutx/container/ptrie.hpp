@@ -20,7 +20,16 @@
 
 #include <stdexcept>
 #include <vector>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
 #include <stdint.h>
+#include <neutx/container/detail/dedup_store.hpp>
+#include <neutx/container/detail/dedup_codec.hpp>
+#include <neutx/container/detail/buffer_store.hpp>
+#include <neutx/container/trie_stats.hpp>
 #include <boost/bind.hpp>
 #include <boost/range.hpp>
 
@@ -43,6 +52,23 @@ void trie_destructor<false>::destroy(T&) {}
 template<> template<typename T>
 void trie_destructor<true>::destroy(T& trie) { trie.clear(); }
 
+// child insertion, concurrent store reclaims replaced child arrays
+template<bool> struct child_inserter {
+    template<typename C, typename F, typename S>
+    static auto ensure(C& coll, typename C::symbol_t sym, F create, S&)
+            -> decltype(coll.ensure(sym, create)) {
+        return coll.ensure(sym, create);
+    }
+};
+
+template<> struct child_inserter<true> {
+    template<typename C, typename F, typename S>
+    static auto ensure(C& coll, typename C::symbol_t sym, F create, S& store)
+            -> decltype(coll.ensure(sym, create, store)) {
+        return coll.ensure(sym, create, store);
+    }
+};
+
 }
 
 // optional const qualifier, used by trie_walker
@@ -160,6 +186,17 @@ struct ptrie_traits_default {
     typedef uint32_t position_type;
 };
 
+/**
+ * \brief trie with persistency support
+ * \tparam Node node type, e.g. detail::pnode or detail::pnode_ss
+ * \tparam Traits key cursor and position types
+ *
+ * With detail::epoch_node_store and detail::cow_svector node parameters
+ * one thread may store() while other threads call fold(), fold_full(),
+ * left_bound() and const foreach() without locking. Node data written by
+ * store() must then be of type assignable atomically (e.g. std::atomic),
+ * make_links() and clear() still require exclusive access.
+ */
 template<typename Node, typename Traits = ptrie_traits_default>
 class ptrie {
 public:
@@ -205,6 +242,31 @@ public:
     // destroy hierarchy of nodes starting with root
     void clear() { clear(m_root_ptr); }
 
+    // memory footprint, nodes are counted each time they are reached
+    // from the root (subtrees shared in DAG image more than once)
+    trie_stats stats() const {
+        typename store_t::read_guard guard(m_store);
+        trie_stats l_stats;
+        std::vector<std::pair<const node_t *, size_t> > l_stack;
+        l_stack.push_back(std::make_pair(&m_root, (size_t)0));
+        while (!l_stack.empty()) {
+            const node_t *n = l_stack.back().first;
+            size_t l_depth = l_stack.back().second;
+            l_stack.pop_back();
+            l_stats.add_node(l_depth, n->children().size());
+            l_stats.node_bytes += sizeof(node_t) - sizeof(n->data());
+            l_stats.payload_bytes += sizeof(n->data());
+            l_stats.child_bytes += n->children().mem_bytes();
+            l_stats.spare_bytes += n->children().spare_bytes();
+            n->children().foreach_keyval([&](symbol_t, ptr_t p) {
+                const node_t *c = node_ptr_or_null(p);
+                if (c)
+                    l_stack.push_back(std::make_pair(c, l_depth + 1));
+            });
+        }
+        return l_stats;
+    }
+
     // store data, overwrite existing data if any
     template<typename Key, typename Data>
     void store(const Key& key, const Data& data) {
@@ -245,6 +307,7 @@ public:
     // traverse const trie
     template<dir_t D, typename Key, typename F>
     void foreach(F functor) const {
+        typename store_t::read_guard guard(m_store);
         trie_walker<node_t, true, D, Key, F> walker(m_store, functor);
         walker.foreach(m_root);
     }
@@ -254,6 +317,7 @@ public:
     // return a pair of flag "left node used" and node pointer (or nullptr)
     template<typename Key>
     std::pair<bool, const node_t*> left_bound(const Key& key) const {
+        typename store_t::read_guard guard(m_store);
         typename traits_t::template cursor<Key>::type cursor(key);
         const node_t *node = &m_root;
         bool left = false;
@@ -279,6 +343,7 @@ public:
     // fold through trie nodes following key components
     template<typename Key, typename A, typename F>
     void fold(const Key& key, A& acc, F proc) const {
+        typename store_t::read_guard guard(m_store);
         typename Traits::template cursor<Key>::type cursor(key);
         node_t *node = &m_root;
         position_t k = 0;
@@ -297,6 +362,7 @@ public:
     // fold through trie nodes following key components and suffix links
     template<typename Key, typename A, typename F>
     void fold_full(const Key& key, A& acc, F proc) const {
+        typename store_t::read_guard guard(m_store);
         typename Traits::template cursor<Key>::type cursor(key);
         node_t *node = &m_root;
         position_t end = 0;
@@ -351,6 +417,49 @@ public:
         return out.store(encoder.buff());
     }
 
+    // write whole trie to output store as minimized DAG: nodes are written
+    // bottom-up, so equal encoded bytes mean equal subtrees, and each
+    // distinct subtree (and payload chunk) is written once; result is
+    // readable by mmap_ptrie fold(), left_bound() and foreach()
+    template<typename Enc, typename Out>
+    typename Enc::addr_type store_dag(Enc& enc, Out& out) const {
+        static_assert(!node_t::has_suffix_links, "suffix links require "
+            "a tree, fold_full() can't work on deduplicated subtrees");
+        typedef typename Enc::addr_type addr_t;
+        typedef detail::dedup_store<Out, addr_t> dag_out_t;
+        detail::dedup_dictionary<addr_t> dict;
+        dag_out_t dag_out(dict, out);
+        typename Enc::trie_encoder encoder(enc);
+        encoder.store(boost::bind(
+            &ptrie::template store_nodes<Enc, dag_out_t>, this,
+            boost::ref(enc), boost::ref(dag_out) ), dag_out);
+        // trie trailer goes to the real store, never shared
+        return out.store(encoder.buff());
+    }
+
+    // same as store_trie(), top level subtrees are encoded by up to
+    // a_threads threads into memory buffers written out in order, nodes
+    // referring to other subtrees (root and suffix links) are written
+    // last, the result is the same; Out must provide pos();
+    // data encoders embed payload addresses in opaque buffers, so the
+    // buffers can't be relocated: each subtree is encoded twice, first
+    // to learn its size and so its position in the output, then at that
+    // position; encoder is copied per subtree, so data encoders with
+    // shared state (e.g. dedup_codec dictionary) are rejected
+    template<typename Enc, typename Out>
+    typename Enc::addr_type store_trie_parallel(Enc& enc, Out& out,
+            unsigned a_threads) const {
+        static_assert(std::is_same<typename detail::encoder_state<
+            typename Enc::data_encoder>::type, detail::no_state>::value,
+            "data encoder state can't be shared by parallel export");
+        parallel_state<Enc> st(a_threads);
+        typename Enc::trie_encoder encoder(enc);
+        encoder.store(boost::bind(
+            &ptrie::template store_nodes_parallel<Enc, Out>, this,
+            boost::ref(enc), boost::ref(out), boost::ref(st) ), out);
+        return out.store(encoder.buff());
+    }
+
 protected:
     // use external root reference
     node_t& get_root(ptr_t a_ptr) {
@@ -391,8 +500,9 @@ protected:
 
     // get child node pointer, create child node if missing
     node_t *next_node(node_t *a_node, symbol_t a_symbol) {
-        return node_ptr(a_node->children().ensure(a_symbol,
-            boost::bind(&ptrie::new_child, this)));
+        return node_ptr(child_inserter<store_t::concurrent>::ensure(
+            a_node->children(), a_symbol,
+            boost::bind(&ptrie::new_child, this), m_store));
     }
 
     // create new child node
@@ -480,6 +590,115 @@ protected:
         return ret;
     }
 
+    // top level subtrees exported in parallel
+    template<typename T>
+    struct parallel_state {
+        typedef typename T::addr_type addr_t;
+        typedef detail::buffer_store<addr_t> buf_store_t;
+
+        unsigned threads;
+        std::vector<ptr_t> nodes;      // subtree roots, symbol order
+        std::vector<uint64_t> base;    // subtree positions in output
+        std::vector<uint64_t> size;    // subtree sizes
+        std::vector<addr_t> addr;      // written subtree root addresses
+        size_t next;                   // next address to return
+
+        parallel_state(unsigned a_threads)
+            : threads(a_threads ? a_threads : 1), next(0) {}
+    };
+
+    template<typename T, typename Out>
+    typename T::addr_type store_nodes_parallel(T& enc, Out& out,
+            parallel_state<T>& st) const {
+        // root payload, then subtrees on the first child address request
+        typename T::addr_type ret = m_root.template write_to_store<T, Out>(
+            m_store, boost::bind(&ptrie::template store_top<T, Out>, this,
+            _1, boost::ref(enc), boost::ref(out), boost::ref(st)), enc, out);
+        m_root.template store_links<T, Out>(m_store, boost::bind(
+            &ptrie::template store_links<T, Out>, this, _1,
+                boost::ref(enc), boost::ref(out)), enc, out);
+        return ret;
+    }
+
+    template<typename T, typename Out> typename T::addr_type
+    store_top(ptr_t, T& enc, Out& out, parallel_state<T>& st) const {
+        if (st.next == 0)
+            export_parallel(enc, out, st);
+        return st.addr.at(st.next++);
+    }
+
+    // encode subtrees [0, n) by st.threads threads, a_out is null for
+    // size only pass, otherwise buffers are written to it in order
+    template<typename T, typename Out>
+    void encode_subtrees(T& enc, Out *a_out, parallel_state<T>& st) const {
+        typedef typename parallel_state<T>::buf_store_t buf_store_t;
+        size_t n = st.nodes.size();
+        std::vector<std::string> l_bufs(n);
+        std::vector<bool> l_done(n);
+        std::vector<std::exception_ptr> l_errors(n);
+        std::atomic<size_t> l_next(0);
+        std::mutex l_mutex;
+        size_t l_written = 0;
+
+        auto work = [&]() {
+            for (size_t i; (i = l_next++) < n; ) {
+                try {
+                    T l_enc(enc);
+                    buf_store_t l_out(st.base[i], a_out != 0);
+                    st.addr[i] = store_child<T, buf_store_t>(st.nodes[i],
+                        l_enc, l_out);
+                    if (a_out && l_out.size() != st.size[i])
+                        throw std::runtime_error("ptrie: subtree size "
+                            "changed between passes");
+                    st.size[i] = l_out.size();
+                    l_bufs[i].swap(l_out.data());
+                } catch (...) {
+                    l_errors[i] = std::current_exception();
+                }
+                std::lock_guard<std::mutex> l_lock(l_mutex);
+                l_done[i] = true;
+                // write out finished buffers in order
+                for (; a_out && l_written < n && l_done[l_written] &&
+                        !l_errors[l_written]; ++l_written) {
+                    std::string& b = l_bufs[l_written];
+                    typename T::addr_type a = a_out->store(
+                        typename Out::buf_t(b.data(), b.size()));
+                    if (!b.empty() && a != st.base[l_written])
+                        l_errors[l_written] = std::make_exception_ptr(
+                            std::runtime_error("ptrie: subtree position"));
+                    std::string().swap(b);
+                }
+            }
+        };
+
+        std::vector<std::thread> l_threads;
+        for (unsigned t = 1; t < st.threads && t < n; ++t)
+            l_threads.push_back(std::thread(work));
+        work();
+        for (size_t t = 0; t < l_threads.size(); ++t)
+            l_threads[t].join();
+        for (size_t i = 0; i < n; ++i)
+            if (l_errors[i])
+                std::rethrow_exception(l_errors[i]);
+    }
+
+    template<typename T, typename Out>
+    void export_parallel(T& enc, Out& out, parallel_state<T>& st) const {
+        m_root.children().foreach_keyval(
+            [&st](symbol_t, ptr_t p) { st.nodes.push_back(p); });
+        size_t n = st.nodes.size();
+        st.base.assign(n, 1);
+        st.size.assign(n, 0);
+        st.addr.assign(n, 0);
+        encode_subtrees<T, Out>(enc, 0, st);
+        uint64_t l_pos = out.pos();
+        for (size_t i = 0; i < n; ++i) {
+            st.base[i] = l_pos;
+            l_pos += st.size[i];
+        }
+        encode_subtrees<T, Out>(enc, &out, st);
+    }
+
     template<typename T, typename Out> typename T::addr_type
     store_child(ptr_t addr, T& enc, Out& out) const {
         return node_ptr(addr)->template write_to_store<T, Out>(m_store,
@@ -0,0 +1,205 @@
+// ex: ts=4 sw=4 ft=cpp et indentexpr=
+/**
+ * \file
+ * \brief k-way merge of sorted key files into exported trie
+ *
+ * Source data coming as many shards sorted by key is merged by a heap
+ * of the shards' current keys and fed to trie_stream_writer, so the
+ * trie image is written without the trie or the shards being loaded:
+ * memory is the read buffers of the shards plus the open trie path.
+ * Payloads of equal keys (in different shards or repeated in one) are
+ * combined by user functor the way ptrie::update() applies UpdateF.
+ *
+ * \author Dmitriy Kargapolov
+ * \since 19 October 2026
+ *
+ */
+
+/*
+ * Copyright (C) 2026 Dmitriy Kargapolov <dmitriy.kargapolov@gmail.com>
+ * Use, modification and distribution are subject to the Boost Software
+ * License, Version 1.0 (See accompanying file LICENSE_1_0.txt or copy
+ * at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef _NEUTX_CONTAINER_TRIE_MERGE_HPP_
+#define _NEUTX_CONTAINER_TRIE_MERGE_HPP_
+
+#include <neutx/container/trie_stream.hpp>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+namespace neutx {
+namespace container {
+
+namespace detail {
+
+// payload parser used by default: Data constructed from C string
+template<typename Data>
+struct parse_data {
+    Data operator()(const std::string& a_value) const {
+        return Data(a_value.c_str());
+    }
+};
+
+} // namespace detail
+
+/**
+ * \brief sorted key source reading lines "key<TAB>payload"
+ * \tparam Data payload type
+ * \tparam Parse functor converting payload string to Data
+ */
+template<typename Data, typename Parse = detail::parse_data<Data> >
+class tsv_key_source {
+    std::vector<char> m_buf;  // read buffer
+    std::ifstream m_ifs;
+    std::string m_fname;
+    std::string m_line;
+    std::string m_key;
+    Data m_data;
+    size_t m_lineno;
+    Parse m_parse;
+
+    // prevent copying
+    tsv_key_source(const tsv_key_source&);
+    tsv_key_source& operator=(const tsv_key_source&);
+
+public:
+    // a_buf_size is read buffer size, e.g. memory budget divided by
+    // number of sources
+    tsv_key_source(const char *a_fname, size_t a_buf_size = 1 << 16,
+            const Parse& a_parse = Parse())
+        : m_buf(a_buf_size ? a_buf_size : 1), m_fname(a_fname)
+        , m_lineno(0), m_parse(a_parse)
+    {
+        // buffer must be set before the file is opened
+        m_ifs.rdbuf()->pubsetbuf(&m_buf[0], m_buf.size());
+        m_ifs.open(a_fname, std::ifstream::in | std::ifstream::binary);
+        if (!m_ifs)
+            throw std::runtime_error("tsv_key_source: can't open " +
+                m_fname);
+    }
+
+    // read next record, return false at end of file
+    bool next() {
+        if (!std::getline(m_ifs, m_line)) {
+            if (m_ifs.bad())
+                throw std::runtime_error("tsv_key_source: read error " +
+                    m_fname);
+            return false;
+        }
+        ++m_lineno;
+        size_t l_tab = m_line.find('\t');
+        if (l_tab == std::string::npos)
+            throw std::runtime_error("tsv_key_source: no payload at " +
+                m_fname + ":" + std::to_string(m_lineno));
+        m_key.assign(m_line, 0, l_tab);
+        m_data = m_parse(m_line.substr(l_tab + 1));
+        return true;
+    }
+
+    const std::string& key() const { return m_key; }
+    const Data& data() const { return m_data; }
+};
+
+namespace detail {
+
+// min-heap order of sources by current key, ties by source number
+template<typename Source>
+struct merge_greater {
+    const std::vector<Source *>& m_src;
+    merge_greater(const std::vector<Source *>& a_src) : m_src(a_src) {}
+    bool operator()(size_t a, size_t b) const {
+        int c = m_src[a]->key().compare(m_src[b]->key());
+        return c > 0 || (c == 0 && a > b);
+    }
+};
+
+} // namespace detail
+
+/**
+ * \brief merge sorted sources into sink
+ * \param a_sources sources with next(), key() and data(), e.g.
+ *        tsv_key_source, positioned before the first record
+ * \param a_sink receiver of add(key, data) calls in ascending key order,
+ *        e.g. trie_stream_writer
+ * \param a_combine functor called as a_combine(Data& acc, const Data& d)
+ *        for each further payload of the same key, in source order
+ * \return number of distinct keys passed to the sink
+ *
+ * Unsorted source results in std::invalid_argument thrown by the sink.
+ */
+template<typename Data, typename Source, typename Sink, typename CombineF>
+size_t merge_sorted(const std::vector<Source *>& a_sources, Sink& a_sink,
+        CombineF a_combine) {
+    std::vector<size_t> l_heap;
+    detail::merge_greater<Source> l_greater(a_sources);
+    for (size_t i = 0; i < a_sources.size(); ++i)
+        if (a_sources[i]->next())
+            l_heap.push_back(i);
+    std::make_heap(l_heap.begin(), l_heap.end(), l_greater);
+
+    size_t l_count = 0;
+    std::string l_key;
+    Data l_acc;
+    while (!l_heap.empty()) {
+        std::pop_heap(l_heap.begin(), l_heap.end(), l_greater);
+        Source *s = a_sources[l_heap.back()];
+        if (l_count == 0 || s->key() != l_key) {
+            if (l_count)
+                a_sink.add(l_key, l_acc);
+            l_key = s->key();
+            l_acc = s->data();
+            ++l_count;
+        } else
+            a_combine(l_acc, s->data());
+        if (s->next())
+            std::push_heap(l_heap.begin(), l_heap.end(), l_greater);
+        else
+            l_heap.pop_back();
+    }
+    if (l_count)
+        a_sink.add(l_key, l_acc);
+    return l_count;
+}
+
+/**
+ * \brief merge sorted "key<TAB>payload" files into trie image file
+ * \param a_budget memory for read buffers, split among the inputs
+ * \return number of distinct keys
+ *
+ * Enc is encoder traits, e.g. digit_trie::encoder_type, the image is
+ * readable by the matching digit_mmap_trie type.
+ */
+template<typename Data, typename Enc, typename CombineF>
+size_t merge_sorted_files(const std::vector<std::string>& a_inputs,
+        const char *a_output, Enc& a_enc, CombineF a_combine,
+        size_t a_budget = 1 << 24) {
+    typedef tsv_key_source<Data> source_t;
+    typedef typename Enc::file_store out_t;
+    size_t l_buf = a_inputs.empty() ? 0 : a_budget / a_inputs.size();
+    std::vector<source_t *> l_sources;
+    try {
+        for (size_t i = 0; i < a_inputs.size(); ++i)
+            l_sources.push_back(new source_t(a_inputs[i].c_str(), l_buf));
+        out_t l_out(a_output);
+        trie_stream_writer<Enc, out_t, Data> l_writer(a_enc, l_out);
+        size_t l_count = merge_sorted<Data>(l_sources, l_writer, a_combine);
+        l_writer.finish();
+        for (size_t i = 0; i < l_sources.size(); ++i)
+            delete l_sources[i];
+        return l_count;
+    } catch (...) {
+        for (size_t i = 0; i < l_sources.size(); ++i)
+            delete l_sources[i];
+        throw;
+    }
+}
+
+} // namespace container
+} // namespace neutx
+
+#endif // _NEUTX_CONTAINER_TRIE_MERGE_HPP_
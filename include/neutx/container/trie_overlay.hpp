@@ -0,0 +1,429 @@
+// ex: ts=4 sw=4 ft=cpp et indentexpr=
+/**
+ * \file
+ * \brief mutable delta layered over read-only trie
+ *
+ * Changes to exported trie (stored payloads and erased keys, the latter
+ * kept as tombstones) go to small in-memory ptrie, lookups and traversal
+ * consult the delta first and the mapped base second, so the base is
+ * re-exported only when the delta grows large. Compaction moves the
+ * delta aside, merges it with the base into new trie file in background
+ * thread while new changes go to fresh delta, and install() switches to
+ * the new base.
+ *
+ * Base payloads are converted to delta payload type by Decode functor:
+ *   bool operator()(const Base::store_t&, node data, Data& out)
+ * returning false if the base node has no payload.
+ *
+ * \author Dmitriy Kargapolov
+ * \since 19 October 2026
+ *
+ */
+
+/*
+ * Copyright (C) 2026 Dmitriy Kargapolov <dmitriy.kargapolov@gmail.com>
+ * Use, modification and distribution are subject to the Boost Software
+ * License, Version 1.0 (See accompanying file LICENSE_1_0.txt or copy
+ * at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef _NEUTX_CONTAINER_TRIE_OVERLAY_HPP_
+#define _NEUTX_CONTAINER_TRIE_OVERLAY_HPP_
+
+#include <neutx/container/ptrie.hpp>
+#include <neutx/container/trie_stream.hpp>
+#include <neutx/container/detail/pnode.hpp>
+#include <neutx/container/detail/svector.hpp>
+#include <neutx/container/detail/simple_node_store.hpp>
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+#include <utility>
+#include <stdexcept>
+
+namespace neutx {
+namespace container {
+
+namespace detail {
+
+// payload of delta node
+template<typename Data>
+struct overlay_entry {
+    enum state_t { none, value, erased };
+    Data data;
+    int state;
+    overlay_entry() : state(none) {}
+    overlay_entry(const Data& a_data) : data(a_data), state(value) {}
+};
+
+} // namespace detail
+
+/**
+ * \brief read-only trie with mutable delta
+ * \tparam Base read-only trie type, e.g. mmap_ptrie
+ * \tparam Data payload type of the delta and of merged results
+ * \tparam Decode base payload converter, see above
+ */
+template<typename Base, typename Data, typename Decode>
+class trie_overlay {
+public:
+    typedef detail::overlay_entry<Data> entry_t;
+    typedef detail::pnode<detail::simple_node_store<>, entry_t,
+        detail::svector<> > delta_node_t;
+    typedef ptrie<delta_node_t> delta_t;
+    typedef typename delta_t::symbol_t symbol_t;
+    typedef typename delta_t::position_t position_t;
+
+private:
+    typedef typename Base::store_t base_store_t;
+    typedef typename delta_t::store_t delta_store_t;
+    typedef std::vector<const entry_t *> delta_path_t;
+    typedef std::vector<std::pair<bool, Data> > base_path_t;
+
+    std::shared_ptr<const Base> m_base;
+    std::unique_ptr<delta_t> m_delta;   // changes
+    std::unique_ptr<delta_t> m_frozen;  // changes being compacted or 0
+    std::future<size_t> m_task;         // running compaction
+    std::string m_next;                 // file being written
+    size_t m_changes;                   // store() and erase() calls
+    size_t m_frozen_changes;            // same, moved aside
+    Decode m_decode;
+
+    // prevent copying
+    trie_overlay(const trie_overlay&);
+    trie_overlay& operator=(const trie_overlay&);
+
+    struct delta_collect {
+        bool operator()(delta_path_t& acc, const entry_t& e,
+                const delta_store_t&, position_t, bool) const {
+            acc.push_back(&e);
+            return true;
+        }
+    };
+
+    struct base_collect {
+        const Decode& m_decode;
+        base_collect(const Decode& a_decode) : m_decode(a_decode) {}
+        template<typename D>
+        bool operator()(base_path_t& acc, const D& d,
+                const base_store_t& store, position_t, bool) const {
+            acc.push_back(std::make_pair(false, Data()));
+            acc.back().first = m_decode(store, d, acc.back().second);
+            return true;
+        }
+    };
+
+    // nodes on the key path in each layer
+    struct paths {
+        delta_path_t delta[2];
+        base_path_t base;
+        size_t depth;
+    };
+
+    template<typename Key>
+    void collect(const Key& key, paths& p) const {
+        const delta_t *l_layers[2] = { m_delta.get(), m_frozen.get() };
+        p.depth = 0;
+        for (int i = 0; i < 2; ++i)
+            if (l_layers[i]) {
+                l_layers[i]->fold(key, p.delta[i], delta_collect());
+                p.depth = std::max(p.depth, p.delta[i].size());
+            }
+        m_base->fold(key, p.base, base_collect(m_decode));
+        p.depth = std::max(p.depth, p.base.size());
+    }
+
+    // merged payload of the node at depth k + 1 or 0
+    static const Data *payload(const paths& p, size_t k) {
+        for (int i = 0; i < 2; ++i)
+            if (k < p.delta[i].size() &&
+                    p.delta[i][k]->state != entry_t::none)
+                return p.delta[i][k]->state == entry_t::value ?
+                    &p.delta[i][k]->data : 0;
+        if (k < p.base.size() && p.base[k].first)
+            return &p.base[k].second;
+        return 0;
+    }
+
+    // true if node a precedes node b in traversal of direction D
+    template<dir_t D, typename Key>
+    static bool before(const Key& a, const Key& b) {
+        size_t n = std::min(a.size(), b.size()), i = 0;
+        while (i < n && a[i] == b[i])
+            ++i;
+        if (i == a.size())
+            return D == down && i < b.size();
+        if (i == b.size())
+            return D == up;
+        return a[i] < b[i];
+    }
+
+    template<typename Key>
+    struct delta_list {
+        typedef std::vector<std::pair<Key, const entry_t *> > type;
+    };
+
+    template<typename Key>
+    struct delta_dump {
+        typename delta_list<Key>::type& m_list;
+        delta_dump(typename delta_list<Key>::type& a_list)
+            : m_list(a_list) {}
+        void operator()(const Key& key, const delta_node_t& node,
+                const delta_store_t&) {
+            m_list.push_back(std::make_pair(key, &node.data()));
+        }
+    };
+
+    // walk base, inserting delta nodes into the sequence
+    template<dir_t D, typename Key, typename F>
+    struct base_walk {
+        const typename delta_list<Key>::type& m_delta;
+        size_t& m_pos;  // next delta node, shared by copies
+        const Decode& m_decode;
+        F& m_fun;
+        Data m_data;
+
+        base_walk(const typename delta_list<Key>::type& a_delta,
+                size_t& a_pos, const Decode& a_decode, F& a_fun)
+            : m_delta(a_delta), m_pos(a_pos), m_decode(a_decode)
+            , m_fun(a_fun)
+        {}
+
+        void emit(const std::pair<Key, const entry_t *>& e) {
+            m_fun(e.first, e.second->state == entry_t::value ?
+                &e.second->data : (const Data *)0);
+        }
+
+        // delta nodes preceding given key or all the rest
+        void flush(const Key *key) {
+            while (m_pos < m_delta.size() &&
+                    (!key || before<D>(m_delta[m_pos].first, *key)))
+                emit(m_delta[m_pos++]);
+        }
+
+        template<typename Node>
+        void operator()(const Key& key, const Node& node,
+                const base_store_t& store) {
+            flush(&key);
+            if (m_pos < m_delta.size() && !before<D>(key,
+                    m_delta[m_pos].first)) {
+                const entry_t *e = m_delta[m_pos++].second;
+                if (e->state != entry_t::none) {
+                    m_fun(key, e->state == entry_t::value ?
+                        &e->data : (const Data *)0);
+                    return;
+                }
+            }
+            m_fun(key, m_decode(store, node.data(), m_data) ?
+                &m_data : (const Data *)0);
+        }
+    };
+
+    // merged traversal of the base and given delta layers
+    template<dir_t D, typename Key, typename F>
+    static void walk(const Base& a_base, const delta_t *const *a_layers,
+            int a_nlayers, const Decode& a_decode, F& a_fun) {
+        typedef typename delta_list<Key>::type list_t;
+        // union of the layers, upper layer wins unless it has no payload
+        list_t l_delta;
+        for (int i = 0; i < a_nlayers; ++i) {
+            if (!a_layers[i])
+                continue;
+            list_t l_layer, l_union;
+            a_layers[i]->template foreach<D, Key>(
+                delta_dump<Key>(l_layer));
+            size_t p = 0, q = 0;
+            while (p < l_delta.size() || q < l_layer.size()) {
+                if (q == l_layer.size() || (p < l_delta.size() &&
+                        before<D>(l_delta[p].first, l_layer[q].first)))
+                    l_union.push_back(l_delta[p++]);
+                else if (p == l_delta.size() ||
+                        before<D>(l_layer[q].first, l_delta[p].first))
+                    l_union.push_back(l_layer[q++]);
+                else {
+                    l_union.push_back(
+                        l_delta[p].second->state != entry_t::none ?
+                        l_delta[p] : l_layer[q]);
+                    ++p;
+                    ++q;
+                }
+            }
+            l_delta.swap(l_union);
+        }
+        size_t l_pos = 0;
+        base_walk<D, Key, F> l_walk(l_delta, l_pos, a_decode, a_fun);
+        a_base.template foreach<D, Key>(l_walk);
+        l_walk.flush(0);
+    }
+
+    // feeds keys with payload to streaming exporter
+    template<typename Writer>
+    struct export_f {
+        Writer& m_writer;
+        size_t& m_count;
+        export_f(Writer& a_writer, size_t& a_count)
+            : m_writer(a_writer), m_count(a_count) {}
+        void operator()(const std::string& key, const Data *data) {
+            if (!data)
+                return;
+            m_writer.add(key, *data);
+            ++m_count;
+        }
+    };
+
+    template<typename Enc>
+    static size_t write(std::shared_ptr<const Base> a_base,
+            const delta_t *a_frozen, const Decode& a_decode,
+            std::string a_fname, Enc& a_enc) {
+        typedef typename Enc::file_store out_t;
+        typedef trie_stream_writer<Enc, out_t, Data> writer_t;
+        out_t l_out(a_fname.c_str());
+        writer_t l_writer(a_enc, l_out);
+        size_t l_count = 0;
+        export_f<writer_t> l_export(l_writer, l_count);
+        walk<down, std::string>(*a_base, &a_frozen, 1, a_decode, l_export);
+        l_writer.finish();
+        return l_count;
+    }
+
+public:
+    trie_overlay(std::shared_ptr<const Base> a_base,
+            const Decode& a_decode = Decode())
+        : m_base(a_base), m_delta(new delta_t), m_changes(0)
+        , m_frozen_changes(0), m_decode(a_decode)
+    {}
+
+    trie_overlay(const char *a_fname, const Decode& a_decode = Decode())
+        : m_base(new Base(a_fname)), m_delta(new delta_t), m_changes(0)
+        , m_frozen_changes(0), m_decode(a_decode)
+    {}
+
+    ~trie_overlay() {
+        if (m_task.valid())
+            m_task.wait();
+    }
+
+    // read-only layer
+    const Base& base() const { return *m_base; }
+
+    // number of changes not yet installed in the base
+    size_t changes() const { return m_changes + m_frozen_changes; }
+
+    // set payload of the key
+    template<typename Key>
+    void store(const Key& key, const Data& data) {
+        m_delta->store(key, entry_t(data));
+        ++m_changes;
+    }
+
+    // remove payload of the key, node itself stays
+    template<typename Key>
+    void erase(const Key& key) {
+        entry_t e;
+        e.state = entry_t::erased;
+        m_delta->store(key, e);
+        ++m_changes;
+    }
+
+    // fold through merged nodes following key components, proc is
+    // called as proc(acc, const Data* payload_or_0, position, has_next)
+    template<typename Key, typename A, typename F>
+    void fold(const Key& key, A& acc, F proc) const {
+        paths p;
+        collect(key, p);
+        typename delta_t::traits_t::template cursor<Key>::type cursor(key);
+        for (size_t k = 0; k < p.depth; ++k) {
+            cursor.next();
+            if (!proc(acc, payload(p, k), (position_t)(k + 1),
+                    cursor.has_data()))
+                break;
+        }
+    }
+
+    // node exactly matching the key or closest left sibling at the level
+    // where current symbol couldn't be matched, as ptrie::left_bound();
+    // return pair of "left node used" flag and "node has payload" flag,
+    // payload is assigned to a_data; digit keys only
+    template<typename Key>
+    std::pair<bool, bool> left_bound(const Key& key, Data& a_data) const {
+        std::string l_key;
+        typename delta_t::traits_t::template cursor<Key>::type cursor(key);
+        for (; cursor.has_data(); cursor.next())
+            l_key.push_back(cursor.get_data());
+        paths p;
+        collect(l_key, p);
+        bool l_left = false;
+        if (p.depth < l_key.size()) {
+            // closest existing sibling to the left
+            std::string l_probe(l_key, 0, p.depth + 1);
+            for (char c = l_probe[p.depth]; c-- > '0'; ) {
+                l_probe[p.depth] = c;
+                paths q;
+                collect(l_probe, q);
+                if (q.depth == l_probe.size()) {
+                    p = q;
+                    l_left = true;
+                    break;
+                }
+            }
+        }
+        const Data *l_data = p.depth ? payload(p, p.depth - 1) : 0;
+        if (l_data)
+            a_data = *l_data;
+        return std::make_pair(l_left, l_data != 0);
+    }
+
+    // traverse merged nodes in order of direction D,
+    // functor is called as f(const Key& key, const Data* payload_or_0)
+    template<dir_t D, typename Key, typename F>
+    void foreach(F functor) const {
+        const delta_t *l_layers[2] = { m_delta.get(), m_frozen.get() };
+        walk<D, Key>(*m_base, l_layers, 2, m_decode, functor);
+    }
+
+    // move changes aside and start writing merged trie to a_fname in
+    // background thread, a_enc must stay valid until install(); new
+    // changes go to fresh delta
+    template<typename Enc>
+    void compact(const std::string& a_fname, Enc& a_enc) {
+        if (m_task.valid())
+            throw std::runtime_error("trie_overlay: compaction is running");
+        if (!m_frozen) {
+            m_frozen.reset(m_delta.release());
+            m_delta.reset(new delta_t);
+            m_frozen_changes = m_changes;
+            m_changes = 0;
+        }
+        m_next = a_fname;
+        m_task = std::async(std::launch::async, &trie_overlay::write<Enc>,
+            m_base, m_frozen.get(), m_decode, m_next, std::ref(a_enc));
+    }
+
+    // true if compaction finished
+    bool ready() const {
+        return m_task.valid() && m_task.wait_for(std::chrono::seconds(0)) ==
+            std::future_status::ready;
+    }
+
+    // wait for compaction, switch to the new base, return number of
+    // keys with payload in it; compaction error is rethrown and moved
+    // aside changes are kept for the next compact() call
+    size_t install() {
+        if (!m_task.valid())
+            throw std::runtime_error("trie_overlay: no compaction");
+        size_t l_count = m_task.get();
+        std::shared_ptr<const Base> l_base(new Base(m_next.c_str()));
+        m_base = l_base;
+        m_frozen.reset();
+        m_frozen_changes = 0;
+        return l_count;
+    }
+};
+
+} // namespace container
+} // namespace neutx
+
+#endif // _NEUTX_CONTAINER_TRIE_OVERLAY_HPP_
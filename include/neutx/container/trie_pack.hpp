@@ -0,0 +1,198 @@
+// ex: ts=4 sw=4 ft=cpp et indentexpr=
+/**
+ * \file
+ * \brief many exported tries in one file
+ *
+ * Tries are exported one after another into the same file, so each
+ * trie image with its trailer is a prefix of the file readable by the
+ * trie reader given the address and the length of the prefix. Names and
+ * directory of image lengths sorted by name follow as written by
+ * detail::flat_dir_writer. Reader maps the file once,
+ * mmap_ptrie, mmap_louds_trie and mmap_da_trie are constructed as views
+ * over regions returned by trie_pack::region().
+ *
+ * \author Dmitriy Kargapolov
+ * \since 19 October 2026
+ *
+ */
+
+/*
+ * Copyright (C) 2026 Dmitriy Kargapolov <dmitriy.kargapolov@gmail.com>
+ * Use, modification and distribution are subject to the Boost Software
+ * License, Version 1.0 (See accompanying file LICENSE_1_0.txt or copy
+ * at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef _NEUTX_CONTAINER_TRIE_PACK_HPP_
+#define _NEUTX_CONTAINER_TRIE_PACK_HPP_
+
+#include <neutx/container/detail/flat_directory.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <stdint.h>
+#include <string>
+#include <stdexcept>
+
+namespace neutx {
+namespace container {
+
+namespace detail {
+
+// output store forwarding to the store shared by many exports
+//
+template<typename Store>
+class store_ref {
+    Store *m_store;
+
+public:
+    typedef typename Store::pointer_t pointer_t;
+    typedef typename Store::buf_t buf_t;
+
+    store_ref(Store& a_store) : m_store(&a_store) {}
+
+    pointer_t null() const { return m_store->null(); }
+
+    pointer_t pos() { return m_store->pos(); }
+
+    pointer_t store(const buf_t& b) {
+        return m_store->store(b);
+    }
+
+    pointer_t store(const buf_t& b1, const buf_t& b2) {
+        return m_store->store(b1, b2);
+    }
+
+    pointer_t store(const buf_t& b1, const buf_t& b2, const buf_t& b3) {
+        return m_store->store(b1, b2, b3);
+    }
+
+    pointer_t store(const buf_t& b1, const buf_t& b2, const buf_t& b3,
+            const buf_t& b4) {
+        return m_store->store(b1, b2, b3, b4);
+    }
+
+    void store_at(pointer_t addr, pointer_t off, const buf_t& buff) {
+        m_store->store_at(addr, off, buff);
+    }
+};
+
+template<typename AddrType>
+struct trie_pack_entry {
+    AddrType name;  // offset of NUL terminated trie name
+    AddrType end;   // length of the prefix ending with trie trailer
+};
+
+static const char trie_pack_magic[8] = "NTXPACK";
+
+} // namespace detail
+
+template<typename AddrType = uint32_t>
+class trie_pack_writer {
+    typedef detail::trie_pack_entry<AddrType> entry_t;
+    typedef detail::flat_dir_writer<entry_t, AddrType> file_t;
+
+public:
+    // output store of trie encoders, e.g. Out parameter of
+    // digit_trie::encoder_type
+    typedef detail::store_ref<typename file_t::store_t> store_type;
+
+private:
+    file_t m_file;
+    store_type m_out;
+
+    // prevent copying
+    trie_pack_writer(const trie_pack_writer&);
+    trie_pack_writer& operator=(const trie_pack_writer&);
+
+    void add_end(const std::string& a_name, AddrType a_trailer) {
+        entry_t e = entry_t();
+        e.end = a_trailer + sizeof(AddrType);
+        m_file.add(a_name, e);
+    }
+
+public:
+    trie_pack_writer(const char *a_fname)
+        : m_file(a_fname, "trie_pack_writer"), m_out(m_file.file())
+    {}
+
+    // export trie under given name, Enc::file_store must be
+    // constructible from store_type
+    template<typename Trie, typename Enc>
+    void add(const std::string& a_name, const Trie& a_trie, Enc& a_enc) {
+        m_file.check(a_name);
+        typename Enc::file_store l_out(m_out);
+        add_end(a_name, a_trie.store_trie(a_enc, l_out));
+    }
+
+    // same as add() but export minimized DAG, see ptrie::store_dag()
+    template<typename Trie, typename Enc>
+    void add_dag(const std::string& a_name, const Trie& a_trie, Enc& a_enc) {
+        m_file.check(a_name);
+        typename Enc::file_store l_out(m_out);
+        add_end(a_name, a_trie.store_dag(a_enc, l_out));
+    }
+
+    // write directory and header, the file is not valid before that
+    void commit() {
+        m_file.commit(detail::trie_pack_magic, sizeof(AddrType));
+    }
+};
+
+namespace { namespace bip = boost::interprocess; }
+
+template<typename AddrType = uint32_t>
+class trie_pack {
+    typedef detail::trie_pack_entry<AddrType> entry_t;
+    typedef detail::flat_dir_reader<entry_t, AddrType> dir_t;
+
+    bip::file_mapping  m_fmap;
+    bip::mapped_region m_reg;
+    dir_t              m_dir;
+
+    // prevent copying
+    trie_pack(const trie_pack&);
+    trie_pack& operator=(const trie_pack&);
+
+public:
+    typedef std::pair<const void *, size_t> region_t;
+
+    trie_pack(const char *a_fname)
+        : m_fmap(a_fname, bip::read_only)
+        , m_reg(m_fmap, bip::read_only)
+        , m_dir(m_reg.get_address(), m_reg.get_size(),
+            detail::trie_pack_magic, sizeof(AddrType), "trie_pack")
+    {
+        for (size_t i = 0; i < m_dir.size(); ++i)
+            if (m_dir.entry(i).end > m_dir.region_size())
+                throw std::runtime_error("trie_pack: bad directory");
+        m_reg.advise(bip::mapped_region::advice_willneed);
+    }
+
+    // number of tries
+    size_t size() const { return m_dir.size(); }
+
+    // trie name by index, tries are ordered by name
+    const char *name(size_t i) const { return m_dir.name(i); }
+
+    // trie index by name or size() if not found
+    size_t find(const char *a_name) const { return m_dir.find(a_name); }
+
+    // memory region to construct trie reader on, valid while the
+    // pack object exists
+    region_t region(size_t i) const {
+        return region_t(m_dir.addr(), m_dir.entry(i).end);
+    }
+
+    region_t region(const char *a_name) const {
+        size_t i = find(a_name);
+        if (i == size())
+            throw std::out_of_range("trie_pack: no trie " +
+                std::string(a_name));
+        return region(i);
+    }
+};
+
+} // namespace container
+} // namespace neutx
+
+#endif // _NEUTX_CONTAINER_TRIE_PACK_HPP_
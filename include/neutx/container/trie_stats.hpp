@@ -0,0 +1,126 @@
+// ex: ts=4 sw=4 ft=cpp et indentexpr=
+/**
+ * \file
+ * \brief memory footprint statistics of ptrie and mmap_ptrie
+ *
+ * Collected by walking the trie from the root: nodes by depth and by
+ * number of children, bytes taken by node objects, child arrays and
+ * payloads held in nodes, unused capacity of growable child arrays.
+ * For mapped trie image, size of the mapping and its part resident in
+ * memory as reported by mincore(2).
+ *
+ * \author Dmitriy Kargapolov
+ * \since 19 October 2026
+ *
+ */
+
+/*
+ * Copyright (C) 2026 Dmitriy Kargapolov <dmitriy.kargapolov@gmail.com>
+ * Use, modification and distribution are subject to the Boost Software
+ * License, Version 1.0 (See accompanying file LICENSE_1_0.txt or copy
+ * at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef _NEUTX_CONTAINER_TRIE_STATS_HPP_
+#define _NEUTX_CONTAINER_TRIE_STATS_HPP_
+
+#include <sys/mman.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <stdint.h>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+namespace neutx {
+namespace container {
+
+struct trie_stats {
+    size_t nodes;
+    std::vector<size_t> depth;   // nodes by depth, root is at depth 0
+    std::vector<size_t> fanout;  // nodes by number of children
+
+    uint64_t node_bytes;     // node objects less payloads
+    uint64_t child_bytes;    // child arrays held apart from node objects
+    uint64_t payload_bytes;  // payloads held in node objects
+    uint64_t spare_bytes;    // unused capacity, part of child_bytes
+
+    // image region of mmap_ptrie, mapped or owned by the caller,
+    // zero for ptrie
+    uint64_t mapped_bytes;
+    uint64_t resident_bytes;
+
+    trie_stats()
+        : nodes(0), node_bytes(0), child_bytes(0), payload_bytes(0)
+        , spare_bytes(0), mapped_bytes(0), resident_bytes(0)
+    {}
+
+    uint64_t total_bytes() const {
+        return node_bytes + child_bytes + payload_bytes;
+    }
+
+    void add_node(size_t a_depth, size_t a_fanout) {
+        ++nodes;
+        if (depth.size() <= a_depth)
+            depth.resize(a_depth + 1);
+        ++depth[a_depth];
+        if (fanout.size() <= a_fanout)
+            fanout.resize(a_fanout + 1);
+        ++fanout[a_fanout];
+    }
+};
+
+inline std::ostream& operator<<(std::ostream& out, const trie_stats& s) {
+    out << "nodes: " << s.nodes
+        << "\nnode bytes: " << s.node_bytes
+        << "\nchild bytes: " << s.child_bytes
+        << " (spare " << s.spare_bytes << ")"
+        << "\npayload bytes: " << s.payload_bytes
+        << "\ntotal bytes: " << s.total_bytes();
+    if (s.mapped_bytes)
+        out << "\nmapped bytes: " << s.mapped_bytes
+            << "\nresident bytes: " << s.resident_bytes;
+    out << "\nnodes by depth:";
+    for (size_t i = 0; i < s.depth.size(); ++i)
+        out << ' ' << s.depth[i];
+    out << "\nnodes by fanout:";
+    for (size_t i = 0; i < s.fanout.size(); ++i)
+        out << ' ' << s.fanout[i];
+    return out;
+}
+
+namespace detail {
+
+// bytes of memory region [a_addr, a_addr + a_size) in pages resident in
+// memory, parts of the first and the last page outside the region are
+// not counted
+inline uint64_t resident_bytes(const void *a_addr, size_t a_size) {
+    if (a_size == 0)
+        return 0;
+    size_t l_page = sysconf(_SC_PAGESIZE);
+    uintptr_t l_addr = (uintptr_t)a_addr;
+    uintptr_t l_begin = l_addr / l_page * l_page;
+    uintptr_t l_end = l_addr + a_size;
+    std::vector<unsigned char> l_vec((l_end - l_begin + l_page - 1) / l_page);
+    if (mincore((void *)l_begin, l_end - l_begin, &l_vec[0]) != 0)
+        throw std::runtime_error(std::string("mincore: ") + strerror(errno));
+    uint64_t l_bytes = 0;
+    for (size_t i = 0; i < l_vec.size(); ++i) {
+        if (!(l_vec[i] & 1))
+            continue;
+        uintptr_t b = std::max(l_begin + i * l_page, l_addr);
+        uintptr_t e = std::min(l_begin + (i + 1) * l_page, l_end);
+        l_bytes += e - b;
+    }
+    return l_bytes;
+}
+
+} // namespace detail
+
+} // namespace container
+} // namespace neutx
+
+#endif // _NEUTX_CONTAINER_TRIE_STATS_HPP_
@@ -0,0 +1,202 @@
+// ex: ts=4 sw=4 ft=cpp et indentexpr=
+/**
+ * \file
+ * \brief trie export from sorted key stream
+ *
+ * Writes the same image as ptrie::store_trie() of the trie holding given
+ * keys, without building the trie: keys come in ascending order, only
+ * the path to the last key is kept open, nodes left behind by the next
+ * key are complete and written out at once. Memory used is proportional
+ * to the key length, payloads are encoded as they arrive.
+ *
+ * \author Dmitriy Kargapolov
+ * \since 19 October 2026
+ *
+ */
+
+/*
+ * Copyright (C) 2026 Dmitriy Kargapolov <dmitriy.kargapolov@gmail.com>
+ * Use, modification and distribution are subject to the Boost Software
+ * License, Version 1.0 (See accompanying file LICENSE_1_0.txt or copy
+ * at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef _NEUTX_CONTAINER_TRIE_STREAM_HPP_
+#define _NEUTX_CONTAINER_TRIE_STREAM_HPP_
+
+#include <neutx/container/ptrie.hpp>
+#include <boost/bind.hpp>
+#include <string>
+#include <vector>
+#include <utility>
+#include <stdexcept>
+
+namespace neutx {
+namespace container {
+
+namespace detail {
+
+// children of open node, written child addresses in symbol order
+//
+template<typename Symbol, typename AddrType>
+class stream_children {
+    std::vector<std::pair<Symbol, AddrType> > m_items;
+
+public:
+    void clear() { m_items.clear(); }
+
+    void add(Symbol a_sym, AddrType a_addr) {
+        m_items.push_back(std::make_pair(a_sym, a_addr));
+    }
+
+    template<typename F> void foreach_keyval(F f) const {
+        for (size_t i = 0; i < m_items.size(); ++i)
+            f(m_items[i].first, m_items[i].second);
+    }
+};
+
+} // namespace detail
+
+/**
+ * \brief streaming trie exporter
+ * \tparam Enc encoder traits as for ptrie::store_trie()
+ * \tparam Out output store
+ * \tparam Data node payload type, default constructed value means
+ *              node without payload as in detail::pnode
+ */
+template<
+    typename Enc, typename Out, typename Data,
+    typename Traits = ptrie_traits_default
+>
+class trie_stream_writer {
+public:
+    typedef typename Enc::addr_type addr_type;
+    typedef char symbol_t;
+
+private:
+    typedef detail::stream_children<symbol_t, addr_type> children_t;
+
+    // node on the path to the last key
+    struct level {
+        symbol_t sym;        // symbol of the edge from parent
+        std::string data;    // encoded payload
+        children_t children; // written children
+    };
+
+    // collection encoder mapping child to its address
+    struct addr_f {
+        addr_type operator()(addr_type a) const { return a; }
+    };
+
+    // source store argument of encoders, there is no source trie
+    struct no_store {};
+
+    Enc& m_enc;
+    Out& m_out;
+    std::vector<level> m_levels; // open path, root first, reused
+    size_t m_depth;              // number of open levels
+    bool m_started;              // root payload encoded
+    bool m_done;
+    no_store m_source;
+
+    // prevent copying
+    trie_stream_writer(const trie_stream_writer&);
+    trie_stream_writer& operator=(const trie_stream_writer&);
+
+    void encode(level& a_level, const Data& a_data) {
+        typename Enc::data_encoder l_encoder(m_enc);
+        l_encoder.store(a_data, m_source, m_out);
+        a_level.data.assign((const char *)l_encoder.buff().first,
+            l_encoder.buff().second);
+    }
+
+    void push(symbol_t a_sym, const Data& a_data) {
+        if (m_depth == m_levels.size())
+            m_levels.push_back(level());
+        level& l = m_levels[m_depth++];
+        l.sym = a_sym;
+        l.children.clear();
+        encode(l, a_data);
+    }
+
+    addr_type write(const level& a_level) {
+        typedef std::pair<const void *, size_t> buf_t;
+        typename Enc::coll_encoder l_encoder(m_enc);
+        l_encoder.store(a_level.children, m_source, addr_f(), m_out);
+        return m_out.store(buf_t(a_level.data.data(), a_level.data.size()),
+            l_encoder.buff());
+    }
+
+    // write out levels deeper than a_depth
+    void pop(size_t a_depth) {
+        while (m_depth > a_depth) {
+            const level& l = m_levels[--m_depth];
+            m_levels[m_depth - 1].children.add(l.sym, write(l));
+        }
+    }
+
+    void start(const Data& a_data) {
+        if (m_done)
+            throw std::runtime_error("trie_stream_writer: finished");
+        if (!m_started) {
+            encode(m_levels[0], a_data);
+            m_started = true;
+        }
+    }
+
+    addr_type close() {
+        pop(1);
+        return write(m_levels[0]);
+    }
+
+public:
+    trie_stream_writer(Enc& a_enc, Out& a_out)
+        : m_enc(a_enc), m_out(a_out), m_levels(1), m_depth(1)
+        , m_started(false), m_done(false)
+    {}
+
+    // add next key, throw std::invalid_argument if the key is not
+    // greater than the previous one
+    template<typename Key>
+    void add(const Key& a_key, const Data& a_data) {
+        typename Traits::template cursor<Key>::type cursor(a_key);
+        if (!m_started && !cursor.has_data()) {
+            start(a_data);
+            return;
+        }
+        start(Data());
+        // common prefix with the previous key
+        size_t p = 1;
+        while (p < m_depth && cursor.has_data() &&
+                cursor.get_data() == m_levels[p].sym) {
+            cursor.next();
+            ++p;
+        }
+        if (!cursor.has_data() ||
+                (p < m_depth && cursor.get_data() < m_levels[p].sym))
+            throw std::invalid_argument("trie_stream_writer: key is not "
+                "greater than previous one");
+        pop(p);
+        symbol_t l_sym = cursor.get_data();
+        for (cursor.next(); cursor.has_data(); cursor.next()) {
+            push(l_sym, Data());
+            l_sym = cursor.get_data();
+        }
+        push(l_sym, a_data);
+    }
+
+    // write remaining nodes and trie trailer, return trailer address
+    // same as ptrie::store_trie()
+    addr_type finish() {
+        start(Data());
+        typename Enc::trie_encoder l_encoder(m_enc);
+        l_encoder.store(boost::bind(&trie_stream_writer::close, this), m_out);
+        m_done = true;
+        return m_out.store(l_encoder.buff());
+    }
+};
+
+} // namespace container
+} // namespace neutx
+
+#endif // _NEUTX_CONTAINER_TRIE_STREAM_HPP_
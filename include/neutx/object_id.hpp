@@ -29,7 +29,8 @@ class object_id {
     I m_id;
 
 protected:
-    object_id() : m_id(++m_cnt) {}
+    // ids only need to be unique, no ordering is implied
+    object_id() : m_id(m_cnt.fetch_add(1, std::memory_order_relaxed) + 1) {}
 
 public:
     const I& oid() const { return m_id; }
@@ -38,6 +39,35 @@ public:
 template<typename T, typename I>
 atomic::atomic_value<I> object_id<T, I>::m_cnt;
 
+/// Same as object_id for objects created by many threads at once: each
+/// thread takes a block of Block ids from the shared counter and hands
+/// them out locally, so the counter is touched once per Block objects.
+/// Ids are unique and increase within a thread, ids of objects created
+/// by different threads are ordered only roughly.
+template<typename T, typename I = unsigned, unsigned Block = 1024>
+class block_object_id {
+    static atomic::atomic_value<I> m_cnt;
+    I m_id;
+
+    static I next_id() {
+        static thread_local I t_next = 0, t_end = 0;
+        if (t_next == t_end) {
+            t_next = m_cnt.fetch_add(Block, std::memory_order_relaxed) + 1;
+            t_end = t_next + Block;
+        }
+        return t_next++;
+    }
+
+protected:
+    block_object_id() : m_id(next_id()) {}
+
+public:
+    const I& oid() const { return m_id; }
+};
+
+template<typename T, typename I, unsigned Block>
+atomic::atomic_value<I> block_object_id<T, I, Block>::m_cnt;
+
 } // namespace neutx
 
 #endif // _NEUTX_OBJECT_ID_HPP_
@@ -0,0 +1,94 @@
+// ex: ts=4 sw=4 ft=cpp et indentexpr=
+/**
+ * \file
+ * \brief counter sharded across threads
+ *
+ * Counter updated by many threads at high rate and read rarely, e.g.
+ * memory usage of memstat_alloc. Each thread updates its own cache line
+ * sized shard with relaxed atomic operation, value is the sum of the
+ * shards. Threads are assigned to shards round robin on first use, so
+ * up to Shards threads never share a cache line.
+ *
+ * \author Dmitriy Kargapolov
+ * \since 19 October 2026
+ *
+ */
+
+/*
+ * Copyright (C) 2026 Dmitriy Kargapolov <dmitriy.kargapolov@gmail.com>
+ * Use, modification and distribution are subject to the Boost Software
+ * License, Version 1.0 (See accompanying file LICENSE_1_0.txt or copy
+ * at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef _NEUTX_SHARDED_COUNTER_HPP_
+#define _NEUTX_SHARDED_COUNTER_HPP_
+
+#include <atomic>
+#include <cstddef>
+
+namespace neutx {
+
+template<typename T = long, unsigned Shards = 64>
+class sharded_counter {
+    // shard, own cache line
+    struct alignas(64) shard_t {
+        std::atomic<T> val;
+    };
+
+    shard_t m_shards[Shards];
+
+    // prevent copying
+    sharded_counter(const sharded_counter&);
+    sharded_counter& operator=(const sharded_counter&);
+
+    static unsigned shard_index() {
+        static std::atomic<unsigned> s_next(0);
+        static thread_local unsigned t_index =
+            s_next.fetch_add(1, std::memory_order_relaxed) % Shards;
+        return t_index;
+    }
+
+public:
+    sharded_counter() { reset(); }
+
+    void add(T n) {
+        m_shards[shard_index()].val.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    void sub(T n) {
+        m_shards[shard_index()].val.fetch_sub(n, std::memory_order_relaxed);
+    }
+
+    // sum of the shards, exact if no updates run concurrently
+    T get() const {
+        T sum = 0;
+        for (unsigned i = 0; i < Shards; ++i)
+            sum += m_shards[i].val.load(std::memory_order_relaxed);
+        return sum;
+    }
+
+    // must not run concurrently with updates
+    void reset() {
+        for (unsigned i = 0; i < Shards; ++i)
+            m_shards[i].val.store(0, std::memory_order_relaxed);
+    }
+};
+
+// memstat_alloc counter policy, one counter per Tag type
+template<typename Tag, typename T = long, unsigned Shards = 64>
+struct sharded_memstat {
+    static void inc(size_t n) { m_cnt.add(n); }
+    static void dec(size_t n) { m_cnt.sub(n); }
+    static T get() { return m_cnt.get(); }
+
+private:
+    static sharded_counter<T, Shards> m_cnt;
+};
+
+template<typename Tag, typename T, unsigned Shards>
+sharded_counter<T, Shards> sharded_memstat<Tag, T, Shards>::m_cnt;
+
+} // namespace neutx
+
+#endif // _NEUTX_SHARDED_COUNTER_HPP_
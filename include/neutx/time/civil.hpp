@@ -0,0 +1,102 @@
+// ex: ts=4 sw=4 ft=cpp et indentexpr=
+/**
+ * \file
+ * \brief civil (proleptic gregorian) date arithmetic
+ *
+ * Constant time conversions between y/m/d dates and days since Epoch,
+ * and between seconds since Epoch and broken-down UTC time, without
+ * loops over years and without calls to gmtime_r(). Calendar is split
+ * into 400-year eras of 146097 days, years starting March 1st, so leap
+ * day is the last day of a year and month lengths follow 153/5 pattern.
+ * Array versions have no data dependent branches and are vectorized by
+ * the compiler.
+ *
+ * \author Dmitriy Kargapolov
+ * \since 19 October 2026
+ *
+ */
+
+/*
+ * Copyright (C) 2026 Dmitriy Kargapolov <dmitriy.kargapolov@gmail.com>
+ * Use, modification and distribution are subject to the Boost Software
+ * License, Version 1.0 (See accompanying file LICENSE_1_0.txt or copy
+ * at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef _NEUTX_TIME_CIVIL_HPP_
+#define _NEUTX_TIME_CIVIL_HPP_
+
+#include <ctime>
+#include <cstddef>
+
+namespace neutx {
+
+namespace time {
+
+// days since Epoch of gregorian date, m in [1, 12], d in [1, 31]
+inline long days_from_civil(long y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    long era = (y - (y < 0) * 399) / 400;
+    unsigned yoe = (unsigned)(y - era * 400);
+    unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + (long)doe - 719468;
+}
+
+// gregorian date of the day since Epoch
+inline void civil_from_days(long z, long& y, unsigned& m, unsigned& d) {
+    z += 719468;
+    long era = (z - (z < 0) * 146096) / 146097;
+    unsigned doe = (unsigned)(z - era * 146097);
+    unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    unsigned mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = (long)yoe + era * 400 + (m <= 2);
+}
+
+// days since Epoch for arrays of dates
+inline void days_from_civil(const long *y, const unsigned *m,
+        const unsigned *d, long *days, size_t n) {
+    for (size_t i = 0; i < n; ++i)
+        days[i] = days_from_civil(y[i], m[i], d[i]);
+}
+
+// dates for array of days since Epoch
+inline void civil_from_days(const long *days, long *y, unsigned *m,
+        unsigned *d, size_t n) {
+    for (size_t i = 0; i < n; ++i)
+        civil_from_days(days[i], y[i], m[i], d[i]);
+}
+
+// broken-down UTC time of seconds since Epoch, standard fields of tm
+// are set as by gmtime_r()
+inline void utc_tm(time_t t, struct tm& tm) {
+    long z = (long)((t - (t < 0) * 86399) / 86400);
+    long s = (long)(t - (time_t)z * 86400);
+    long y; unsigned m, d;
+    civil_from_days(z, y, m, d);
+    tm.tm_year = (int)(y - 1900);
+    tm.tm_mon = m - 1;
+    tm.tm_mday = d;
+    tm.tm_hour = s / 3600;
+    tm.tm_min = s / 60 % 60;
+    tm.tm_sec = s % 60;
+    // 1 January 1970 was Thursday
+    tm.tm_wday = (int)((z % 7 + 11) % 7);
+    tm.tm_yday = (int)(z - days_from_civil(y, 1, 1));
+    tm.tm_isdst = 0;
+}
+
+// same for array of times
+inline void utc_tm(const time_t *t, struct tm *tm, size_t n) {
+    for (size_t i = 0; i < n; ++i)
+        utc_tm(t[i], tm[i]);
+}
+
+} // namespace time
+
+} // namespace neutx
+
+#endif // _NEUTX_TIME_CIVIL_HPP_
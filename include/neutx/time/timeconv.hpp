@@ -20,7 +20,13 @@
 
 #include <ctime>
 #include <map>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <stdint.h>
 #include <boost/integer_traits.hpp>
+#include <neutx/time/civil.hpp>
+#include <neutx/time/tzfile.hpp>
 
 namespace neutx {
 
@@ -38,12 +44,8 @@ inline bool is_leap(int year) {
 
 // calculate time difference between two broken-time points
 inline long tmdiff(const struct tm& t1, const struct tm& t2) {
-    if (t1.tm_year < t2.tm_year)
-        return -tmdiff(t2, t1);
-    long result = 0;
-    for (int y = t2.tm_year; y < t1.tm_year; ++y)
-        result += 365 + is_leap(1900 + y);
-    result += t1.tm_yday - t2.tm_yday;
+    long result = days_from_civil(1900L + t1.tm_year, 1, 1) + t1.tm_yday -
+        days_from_civil(1900L + t2.tm_year, 1, 1) - t2.tm_yday;
     result *= 24;
     result += t1.tm_hour - t2.tm_hour;
     result *= 60;
@@ -55,17 +57,8 @@ inline long tmdiff(const struct tm& t1, const struct tm& t2) {
 
 // calculate seconds since Epoch from broken time
 inline time_t to_secs(int y, int n, int d, int h, int m, int s) {
-    static int dm[] =
-        {0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334};
-    // days in prev years
-    int x = y - 1;
-    int dy = x/4 - x/100 + x/400 + x*365 + 366;
-    // leap y adjustment for month 3..12
-    int ly = n > 2 && is_leap(y) ? 1 : 0;
-    // UTC days == gregorian days - 719528
-    int days = dy + dm[n - 1] + ly + d - 719529;
-    // UTC secs
-    return (time_t) days * 86400 + h * 3600 + m * 60 + s;
+    return (time_t)days_from_civil(y, n, d) * 86400 +
+        h * 3600 + m * 60 + s;
 }
 
 struct tim {
@@ -101,34 +94,13 @@ struct tim {
 
 namespace {
 
-inline long year_seconds(long year) {
-    if (is_leap(year))
-        return 366 * 24 * 3600;
-    else
-        return 365 * 24 * 3600;
-}
-
 inline time_t year_to_time_t(long year) {
-    long t = 0;
-    long y = 1970;
-    while (y != year) {
-        if (y < year) {
-            long seconds = year_seconds(y++);
-            if (t > maxtime - seconds) {
-                t = maxtime;
-                break;
-            }
-            t += seconds;
-        } else {
-            long seconds = year_seconds(--y);
-            if (t < mintime + seconds) {
-                t = mintime;
-                break;
-            }
-            t -= seconds;
-        }
-    }
-    return t;
+    long days = days_from_civil(year, 1, 1);
+    if (days > maxtime / 86400)
+        return maxtime;
+    if (days < mintime / 86400)
+        return mintime;
+    return (time_t)days * 86400;
 }
 
 inline void hunt(tim& t1, tim& t2) {
@@ -152,8 +124,159 @@ inline void hunt(tim& t1, tim& t2) {
 
 } // anonymous namespace
 
+// read-only array either owning its elements or referring to elements
+// kept elsewhere, e.g. in memory mapped snapshot (see tzsnapshot.hpp)
+template <typename T>
+class flat_array {
+    std::vector<T> m_own;
+    const T *m_data;
+    size_t m_size;
+
+public:
+    flat_array() : m_data(0), m_size(0) {}
+
+    flat_array(const flat_array& a)
+        : m_own(a.m_own)
+        , m_data(a.m_data == a.m_own.data() ? m_own.data() : a.m_data)
+        , m_size(a.m_size)
+    {}
+
+    flat_array& operator=(const flat_array& a) {
+        if (this != &a) {
+            m_own = a.m_own;
+            m_data = a.m_data == a.m_own.data() ? m_own.data() : a.m_data;
+            m_size = a.m_size;
+        }
+        return *this;
+    }
+
+    // copy elements
+    template<typename It>
+    void assign(It begin, It end) {
+        m_own.assign(begin, end);
+        m_data = m_own.data();
+        m_size = m_own.size();
+    }
+
+    // refer to external elements, they must outlive the array
+    void attach(const T *a_data, size_t a_size) {
+        std::vector<T>().swap(m_own);
+        m_data = a_data;
+        m_size = a_size;
+    }
+
+    const T *data() const { return m_data; }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    const T& operator[](size_t i) const { return m_data[i]; }
+    const T& back() const { return m_data[m_size - 1]; }
+};
+
+// frozen sorted sequence of switch times with bucket index: bucket
+// covering 2^shift seconds holds position of its first time, so the
+// upper bound is one bucket load plus fixed number of compare-and-add
+// steps over the times of that bucket
+class switch_index {
+public:
+    enum {
+        min_shift = 25,        // ~1 year buckets
+        max_buckets = 1 << 16
+    };
+
+private:
+    flat_array<time_t> m_times;     // sorted times, sentinel padded
+    flat_array<uint32_t> m_buckets; // index of first time >= bucket start
+    time_t m_base;                  // start of the first bucket
+    int m_shift;                    // log2 of bucket size in seconds
+    unsigned m_span;                // max number of times in a bucket
+    size_t m_size;                  // number of times
+
+public:
+    switch_index() : m_base(0), m_shift(min_shift), m_span(0), m_size(0) {}
+
+    // build from sorted sequence of times
+    template<typename It>
+    void assign(It begin, It end) {
+        std::vector<time_t> l_times(begin, end);
+        m_size = l_times.size();
+        m_span = 0;
+        if (m_size == 0) {
+            m_times.attach(0, 0);
+            m_buckets.attach(0, 0);
+            return;
+        }
+        m_base = l_times.front();
+        double range = (double)l_times.back() - m_base;
+        for (m_shift = min_shift; range / ((time_t)1 << m_shift) >=
+                max_buckets; ++m_shift) ;
+        size_t nb = (((uint64_t)l_times.back() - (uint64_t)m_base) >>
+            m_shift) + 1;
+        std::vector<uint32_t> l_buckets(nb);
+        for (size_t b = 0, i = 0; b < nb; ++b) {
+            time_t start = m_base + ((time_t)b << m_shift);
+            while (i < m_size && l_times[i] < start)
+                ++i;
+            l_buckets[b] = i;
+            if (b > 0)
+                m_span = std::max<unsigned>(m_span, i - l_buckets[b - 1]);
+        }
+        m_span = std::max<unsigned>(m_span, m_size - l_buckets.back());
+        l_times.resize(m_size + m_span, maxtime);
+        m_times.assign(l_times.begin(), l_times.end());
+        m_buckets.assign(l_buckets.begin(), l_buckets.end());
+    }
+
+    // refer to index built elsewhere: a_times holds size + span
+    // padded times, a_buckets holds a_nbuckets bucket positions
+    void attach(time_t a_base, int a_shift, unsigned a_span, size_t a_size,
+            const time_t *a_times, const uint32_t *a_buckets,
+            size_t a_nbuckets) {
+        m_base = a_base;
+        m_shift = a_shift;
+        m_span = a_span;
+        m_size = a_size;
+        m_times.attach(a_times, a_size ? a_size + a_span : 0);
+        m_buckets.attach(a_buckets, a_size ? a_nbuckets : 0);
+    }
+
+    // index parameters, see attach()
+    time_t base() const { return m_base; }
+    int shift() const { return m_shift; }
+    unsigned span() const { return m_span; }
+    const flat_array<time_t>& times() const { return m_times; }
+    const flat_array<uint32_t>& buckets() const { return m_buckets; }
+
+    size_t size() const { return m_size; }
+
+    // position of the first time greater than t or size()
+    size_t upper_bound(time_t t) const {
+        if (m_size == 0 || t < m_base)
+            return 0;
+        // unsigned difference, t - m_base may overflow time_t
+        size_t b = std::min<uint64_t>(
+            ((uint64_t)t - (uint64_t)m_base) >> m_shift,
+            m_buckets.size() - 1);
+        size_t i = m_buckets[b];
+        const time_t *p = m_times.data() + i;
+        for (unsigned k = 0; k < m_span; ++k)
+            i += p[k] <= t;
+        return std::min(i, m_size);
+    }
+
+    // same, also set [lo, hi) to the interval between adjacent
+    // times containing t
+    size_t upper_bound(time_t t, time_t& lo, time_t& hi) const {
+        size_t i = upper_bound(t);
+        lo = i > 0 ? m_times[i - 1] : (time_t)mintime;
+        hi = i < m_size ? m_times[i] : (time_t)maxtime;
+        return i;
+    }
+};
+
 class tzdata {
     friend class tzdata_codec;
+    friend class tzsnapshot;
+    friend class tzsnapshot_writer;
 
 public:
     // timezone offset switch point
@@ -168,6 +291,14 @@ public:
         long off2; // new seconds east of UTC
     };
 
+    // resolution of local times skipped (gap) or repeated (overlap)
+    // by a switch, in terms of the offset used to convert them
+    enum switch_policy {
+        pre_switch,  // offset in effect before the switch
+        post_switch, // offset in effect after the switch
+        strict       // throw std::invalid_argument
+    };
+
 private:
     // local secs to shift point map type
 #ifdef TEST_ALLOC
@@ -243,34 +374,151 @@ private:
             t2.localtime();
             if (!t2.compare_diffs(t1)) {
                 hunt(t1, t2);
-                long o1 = tmdiff(t1.m_tm, t1.m_tm_utc);
-                long o2 = tmdiff(t2.m_tm, t2.m_tm_utc);
-                if (o1 < 0 && t2.m_t < mintime - o1) continue;
-                if (o1 > 0 && t2.m_t > maxtime - o1) continue;
-                if (o2 < 0 && t2.m_t < mintime - o2) continue;
-                if (o2 > 0 && t2.m_t > maxtime - o2) continue;
-                // time gap
-                if (o1 < o2) {
-                    m_ltztree[t2.m_t + o1].set(t2.m_t, o1, o1);
-                    m_ltztree[t2.m_t + o2].set(t2.m_t, o1, o2);
-                    m_utztree[t2.m_t].set(o1, false);
-                    m_def_is_dst = true;
+                add_switch(t2.m_t, tmdiff(t1.m_tm, t1.m_tm_utc),
+                    tmdiff(t2.m_tm, t2.m_tm_utc));
+            }
+        }
+    }
+
+    // same as above using rules read from compiled timezone file
+    void load_tztree(int y1, int y2, const tzfile& zone) {
+        m_lotime = year_to_time_t(y1);
+        m_hitime = year_to_time_t(y2);
+        m_switch_t = m_hitime;
+        m_def_offset = zone.type_at(1398127371).utoff;
+
+        std::vector<tz_transition> l_trans;
+        zone.transitions(m_lotime, m_hitime, l_trans);
+        long o1 = zone.type_at(m_lotime).utoff;
+        for (size_t i = 0; i < l_trans.size(); ++i) {
+            long o2 = l_trans[i].type.utoff;
+            if (o2 == o1)
+                continue;
+            add_switch(l_trans[i].t, o1, o2);
+            o1 = o2;
+        }
+    }
+
+    // register switch from offset o1 to o2 at time t
+    void add_switch(time_t t, long o1, long o2) {
+        if (o1 < 0 && t < mintime - o1) return;
+        if (o1 > 0 && t > maxtime - o1) return;
+        if (o2 < 0 && t < mintime - o2) return;
+        if (o2 > 0 && t > maxtime - o2) return;
+        // time gap
+        if (o1 < o2) {
+            m_ltztree[t + o1].set(t, o1, o1);
+            m_ltztree[t + o2].set(t, o1, o2);
+            m_utztree[t].set(o1, false);
+            m_def_is_dst = true;
+        }
+        // time repetition
+        else if (o1 > o2) {
+            m_ltztree[t + o2].set(t, o1, o1);
+            m_ltztree[t + o1].set(t, o1, o2);
+            m_utztree[t].set(o1, true);
+            m_def_is_dst = false;
+        }
+        m_switch_t = t;
+        m_def_offset = o2;
+    }
+
+    // interval of input times converted with the same offset
+    struct conv_span {
+        time_t lo, hi;  // [lo, hi)
+        long off;
+        bool dst;
+        conv_span() : lo(0), hi(0), off(0), dst(false) {}
+        bool has(time_t t) const { return (t >= lo) & (t < hi); }
+    };
+
+    enum { conv_block = 8 };
+
+    // span of utc time t
+    void utc_span(time_t t, conv_span& s) const {
+        size_t i = m_uindex.upper_bound(t, s.lo, s.hi);
+        if (i == m_uoffsets.size()) {
+            s.off = m_def_offset;
+            s.dst = m_def_is_dst;
+        } else {
+            s.off = m_uoffsets[i].offset;
+            s.dst = m_uoffsets[i].is_dst;
+        }
+    }
+
+    // span of local time t, dst flag is set only if requested
+    void local_span(time_t t, switch_policy a_policy, bool a_dst,
+            conv_span& s) const {
+        size_t i = m_lindex.upper_bound(t, s.lo, s.hi);
+        long o1 = m_def_offset, o2 = m_def_offset;
+        if (i < m_lpoints.size()) {
+            o1 = m_lpoints[i].off1;
+            o2 = m_lpoints[i].off2;
+        }
+        if (o1 == o2 || a_policy == pre_switch)
+            s.off = o1;
+        else if (a_policy == post_switch)
+            s.off = o2;
+        else
+            throw std::invalid_argument(
+                "tzdata: local time skipped or repeated by switch");
+        // all times of the span map into one utc span
+        if (a_dst)
+            offset(t - s.off, s.dst);
+    }
+
+    // convert utc to local times or back, full blocks of times falling
+    // into the cached span take branch-free path the compiler vectorizes
+    template<bool FromLocal>
+    void convert(const time_t *in, time_t *out, size_t n, bool *is_dst,
+            switch_policy a_policy) const {
+        conv_span s;
+        size_t k = 0;
+        while (k < n) {
+            size_t m = std::min<size_t>(conv_block, n - k);
+            if (m == conv_block) {
+                // local copies, out may alias the span otherwise
+                const time_t lo = s.lo, hi = s.hi;
+                const time_t d = FromLocal ? -s.off : s.off;
+                const time_t *x = in + k;
+                int ok = 1;
+                for (int j = 0; j < conv_block; ++j)
+                    ok &= (x[j] >= lo) & (x[j] < hi);
+                if (ok) {
+                    time_t y[conv_block];
+                    for (int j = 0; j < conv_block; ++j)
+                        y[j] = x[j] + d;
+                    std::copy(y, y + conv_block, out + k);
+                    if (is_dst)
+                        std::fill(is_dst + k, is_dst + k + m, s.dst);
+                    k += m;
+                    continue;
                 }
-                // time repetition
-                else if (o1 > o2) {
-                    m_ltztree[t2.m_t + o2].set(t2.m_t, o1, o1);
-                    m_ltztree[t2.m_t + o1].set(t2.m_t, o1, o2);
-                    m_utztree[t2.m_t].set(o1, true);
-                    m_def_is_dst = false;
+            }
+            // block crosses span boundaries, convert one by one
+            for (size_t e = k + m; k < e; ++k) {
+                time_t t = in[k];
+                if (!s.has(t)) {
+                    if (FromLocal)
+                        local_span(t, a_policy, is_dst != 0, s);
+                    else
+                        utc_span(t, s);
                 }
-                m_switch_t = t2.m_t;
-                m_def_offset = o2;
+                out[k] = FromLocal ? t - s.off : t + s.off;
+                if (is_dst)
+                    is_dst[k] = s.dst;
             }
         }
     }
 
+    // construction only, released by freeze()
     ltztree_t m_ltztree; // local secs to shift point ordered map
     utztree_t m_utztree; // utc secs to offset ordered map
+    // frozen content of the trees used for lookups
+    switch_index m_lindex;             // keys of m_ltztree
+    flat_array<shift_point> m_lpoints; // values of m_ltztree
+    switch_index m_uindex;             // keys of m_utztree
+    flat_array<loc_offset> m_uoffsets; // values of m_utztree
     time_t m_switch_t;   // time of last switch or m_hitime if no switch exists
     long m_def_offset;   // default tz offset
     bool m_def_is_dst;   // default dst flag
@@ -286,39 +534,93 @@ public:
             load_tztree(y1, y2, tz);
         else
             load_tztree(y1, y2);
+        freeze();
+    }
+
+    // construct tzdata from compiled timezone file, faster than above
+    // and doesn't touch TZ environment variable
+    tzdata(int y1, int y2, const tzfile& zone)
+        : m_def_is_dst(false)
+    {
+        load_tztree(y1, y2, zone);
+        freeze();
+    }
+
+    // build lookup arrays from the trees and release the trees, must be
+    // called if the trees are filled other way than by constructor;
+    // does nothing if the trees are empty, e.g. called again
+    void freeze() {
+        if (m_ltztree.empty() && m_utztree.empty())
+            return;
+        std::vector<time_t> keys;
+        std::vector<shift_point> l_points;
+        for (ltztree_t::const_iterator it = m_ltztree.begin();
+                it != m_ltztree.end(); ++it) {
+            keys.push_back(it->first);
+            l_points.push_back(it->second);
+        }
+        m_lindex.assign(keys.begin(), keys.end());
+        m_lpoints.assign(l_points.begin(), l_points.end());
+        keys.clear();
+        std::vector<loc_offset> l_offsets;
+        for (utztree_t::const_iterator it = m_utztree.begin();
+                it != m_utztree.end(); ++it) {
+            keys.push_back(it->first);
+            l_offsets.push_back(it->second);
+        }
+        m_uindex.assign(keys.begin(), keys.end());
+        m_uoffsets.assign(l_offsets.begin(), l_offsets.end());
+        m_ltztree.clear();
+        m_utztree.clear();
     }
 
     // get offset(s) for local time represented in seconds
     void offset(time_t local_secs, shift_point& ret) const {
-        ltztree_t::const_iterator it = m_ltztree.upper_bound(local_secs);
-        if (it == m_ltztree.end()) {
+        size_t i = m_lindex.upper_bound(local_secs);
+        if (i == m_lpoints.size()) {
             ret.t0 = m_switch_t;
             ret.off1 = m_def_offset;
             ret.off2 = m_def_offset;
         } else
-            ret = it->second;
+            ret = m_lpoints[i];
     }
 
     // get offset for utc time represented in seconds
     long offset(time_t utc_secs) const {
-        utztree_t::const_iterator it = m_utztree.upper_bound(utc_secs);
-        if (it == m_utztree.end()) {
+        size_t i = m_uindex.upper_bound(utc_secs);
+        if (i == m_uoffsets.size()) {
             return m_def_offset;
         } else
-            return it->second.offset;
+            return m_uoffsets[i].offset;
     }
 
     // get offset for utc time represented in seconds and set dst flag
     long offset(time_t utc_secs, bool& dst) const {
-        utztree_t::const_iterator it = m_utztree.upper_bound(utc_secs);
-        if (it == m_utztree.end()) {
+        size_t i = m_uindex.upper_bound(utc_secs);
+        if (i == m_uoffsets.size()) {
             dst = m_def_is_dst;
             return m_def_offset;
         } else {
-            dst = it->second.is_dst;
-            return it->second.offset;
+            dst = m_uoffsets[i].is_dst;
+            return m_uoffsets[i].offset;
         }
     }
+
+    // convert n utc times to local times, optionally set dst flags;
+    // sorted or clustered input is converted mostly without lookups,
+    // in and out may be the same array
+    void to_local(const time_t *in, time_t *out, size_t n,
+            bool *is_dst = 0) const {
+        convert<false>(in, out, n, is_dst, pre_switch);
+    }
+
+    // convert n local times to utc times resolving local times in
+    // switch gaps and overlaps by given policy, optionally set dst
+    // flags of the result; same notes as above
+    void to_utc(const time_t *in, time_t *out, size_t n,
+            switch_policy a_policy = pre_switch, bool *is_dst = 0) const {
+        convert<true>(in, out, n, is_dst, a_policy);
+    }
 };
 
 } // namespace time
@@ -0,0 +1,223 @@
+// ex: ts=4 sw=4 ft=cpp et indentexpr=
+/**
+ * \file
+ * \brief fixed-width timestamp parsing and formatting
+ *
+ * Replacement of strptime() + mktime() and localtime_r() + strftime()
+ * for timestamps of fixed layout, e.g. in logs and CDRs, converted in
+ * given timezone instead of the global TZ. Digits are validated and
+ * converted eight at a time within 64-bit words, local times skipped
+ * or repeated by a timezone switch are resolved by tzdata policy.
+ *
+ * \author Dmitriy Kargapolov
+ * \since 19 October 2026
+ *
+ */
+
+/*
+ * Copyright (C) 2026 Dmitriy Kargapolov <dmitriy.kargapolov@gmail.com>
+ * Use, modification and distribution are subject to the Boost Software
+ * License, Version 1.0 (See accompanying file LICENSE_1_0.txt or copy
+ * at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef _NEUTX_TIME_TIMESTAMP_HPP_
+#define _NEUTX_TIME_TIMESTAMP_HPP_
+
+#include <neutx/time/civil.hpp>
+#include <neutx/time/timeconv.hpp>
+#include <stdint.h>
+#include <string.h>
+#include <stdexcept>
+#include <string>
+
+namespace neutx {
+
+namespace time {
+
+// supported layouts
+enum ts_layout {
+    ts_compact, // YYYYMMDDhhmmss
+    ts_iso,     // YYYY-MM-DDThh:mm:ss
+    ts_sql      // YYYY-MM-DD hh:mm:ss
+};
+
+// length of timestamp of given layout, no terminating NUL
+inline size_t ts_length(ts_layout a_layout) {
+    return a_layout == ts_compact ? 14 : 19;
+}
+
+namespace detail {
+
+// positions of separators and digits in extended layouts
+static const char ts_ext_seps[] = "--T::";
+static const unsigned char ts_ext_sep_pos[] = { 4, 7, 10, 13, 16 };
+static const unsigned char ts_ext_digit_pos[] =
+    { 0, 1, 2, 3, 5, 6, 8, 9, 11, 12, 14, 15, 17, 18 };
+
+// check that all eight bytes are decimal digits
+inline bool ts_digits8(uint64_t v) {
+    return (((v & 0xF0F0F0F0F0F0F0F0ull) |
+        (((v + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4)) ==
+        0x3333333333333333ull);
+}
+
+// values of four two-digit numbers of eight digits, first one in the
+// lowest 16 bits
+inline uint64_t ts_pairs8(uint64_t v) {
+    v -= 0x3030303030303030ull;
+    return (v * 10 + (v >> 8)) & 0x00FF00FF00FF00FFull;
+}
+
+// eight bytes in memory order, first one in the lowest byte
+inline uint64_t ts_load8(const char *s) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint64_t v;
+    memcpy(&v, s, sizeof(v));
+    return v;
+#else
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; --i)
+        v = v << 8 | (unsigned char)s[i];
+    return v;
+#endif
+}
+
+// "00" to "99"
+static const char ts_digit_pairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233"
+    "34353637383940414243444546474849505152535455565758596061626364656667"
+    "6869707172737475767778798081828384858687888990919293949596979899";
+
+inline void ts_put2(char *p, unsigned v) {
+    memcpy(p, ts_digit_pairs + 2 * v, 2);
+}
+
+inline bool ts_valid(long y, unsigned m, unsigned d, unsigned hh,
+        unsigned mm, unsigned ss) {
+    static const unsigned char mdays[] =
+        { 31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    if (m < 1 || m > 12 || d < 1 || d > mdays[m - 1])
+        return false;
+    if (m == 2 && d == 29 && !is_leap(y))
+        return false;
+    return hh < 24 && mm < 60 && ss < 60;
+}
+
+} // namespace detail
+
+// parse timestamp of given layout into local seconds since Epoch,
+// return false if it is malformed
+inline bool parse_local(const char *s, ts_layout a_layout, time_t& a_local) {
+    char l_buf[16];
+    if (a_layout != ts_compact) {
+        // move digits together, check separators
+        unsigned bad = 0;
+        for (int i = 0; i < 5; ++i)
+            bad |= s[detail::ts_ext_sep_pos[i]] ^ (i == 2 &&
+                a_layout == ts_sql ? ' ' : detail::ts_ext_seps[i]);
+        if (bad)
+            return false;
+        for (int i = 0; i < 14; ++i)
+            l_buf[i] = s[detail::ts_ext_digit_pos[i]];
+        s = l_buf;
+    }
+    // YYYYMMDD and DDhhmmss
+    uint64_t v1 = detail::ts_load8(s);
+    uint64_t v2 = detail::ts_load8(s + 6);
+    if (!detail::ts_digits8(v1) || !detail::ts_digits8(v2))
+        return false;
+    v1 = detail::ts_pairs8(v1);
+    v2 = detail::ts_pairs8(v2);
+    long y = (long)(v1 & 0xFF) * 100 + (long)(v1 >> 16 & 0xFF);
+    unsigned m = v1 >> 32 & 0xFF, d = v1 >> 48 & 0xFF;
+    unsigned hh = v2 >> 16 & 0xFF, mm = v2 >> 32 & 0xFF, ss = v2 >> 48 & 0xFF;
+    if (!detail::ts_valid(y, m, d, hh, mm, ss))
+        return false;
+    a_local = (time_t)days_from_civil(y, m, d) * 86400 +
+        hh * 3600 + mm * 60 + ss;
+    return true;
+}
+
+// parse timestamp of given layout as local time of the timezone,
+// return UTC seconds since Epoch; throw std::invalid_argument
+// if timestamp is malformed or rejected by the policy
+inline time_t parse(const char *s, ts_layout a_layout, const tzdata& a_tz,
+        tzdata::switch_policy a_policy = tzdata::pre_switch) {
+    time_t l_local;
+    if (!parse_local(s, a_layout, l_local))
+        throw std::invalid_argument("bad timestamp: " +
+            std::string(s, ts_length(a_layout)));
+    time_t l_utc;
+    a_tz.to_utc(&l_local, &l_utc, 1, a_policy);
+    return l_utc;
+}
+
+// parse n timestamps placed a_stride bytes apart, e.g. fixed position
+// fields of fixed size records; same notes as above
+inline void parse(const char *s, size_t a_stride, size_t n,
+        ts_layout a_layout, const tzdata& a_tz, time_t *out,
+        tzdata::switch_policy a_policy = tzdata::pre_switch) {
+    for (size_t i = 0; i < n; ++i, s += a_stride)
+        if (!parse_local(s, a_layout, out[i]))
+            throw std::invalid_argument("bad timestamp: " +
+                std::string(s, ts_length(a_layout)));
+    a_tz.to_utc(out, out, n, a_policy);
+}
+
+// format local seconds since Epoch, writes ts_length() chars, no NUL;
+// throw std::out_of_range if year is out of [0, 9999]
+inline void format_local(time_t a_local, ts_layout a_layout, char *out) {
+    long z = (long)((a_local - (a_local < 0) * 86399) / 86400);
+    unsigned s = (unsigned)(a_local - (time_t)z * 86400);
+    long y; unsigned m, d;
+    civil_from_days(z, y, m, d);
+    if (y < 0 || y > 9999)
+        throw std::out_of_range("timestamp year out of range");
+    char *p = out;
+    detail::ts_put2(p, y / 100);
+    detail::ts_put2(p + 2, y % 100);
+    if (a_layout == ts_compact) {
+        detail::ts_put2(p + 4, m);
+        detail::ts_put2(p + 6, d);
+        detail::ts_put2(p + 8, s / 3600);
+        detail::ts_put2(p + 10, s / 60 % 60);
+        detail::ts_put2(p + 12, s % 60);
+        return;
+    }
+    p[4] = '-';
+    detail::ts_put2(p + 5, m);
+    p[7] = '-';
+    detail::ts_put2(p + 8, d);
+    p[10] = a_layout == ts_sql ? ' ' : 'T';
+    detail::ts_put2(p + 11, s / 3600);
+    p[13] = ':';
+    detail::ts_put2(p + 14, s / 60 % 60);
+    p[16] = ':';
+    detail::ts_put2(p + 17, s % 60);
+}
+
+// format UTC seconds since Epoch as local time of the timezone
+inline void format(time_t a_utc, ts_layout a_layout, const tzdata& a_tz,
+        char *out) {
+    format_local(a_utc + a_tz.offset(a_utc), a_layout, out);
+}
+
+// format n times into fields placed a_stride bytes apart
+inline void format(const time_t *t, size_t n, ts_layout a_layout,
+        const tzdata& a_tz, char *out, size_t a_stride) {
+    enum { chunk = 256 };
+    time_t l_local[chunk];
+    for (size_t i = 0; i < n; i += chunk) {
+        size_t k = std::min<size_t>(chunk, n - i);
+        a_tz.to_local(t + i, l_local, k);
+        for (size_t j = 0; j < k; ++j, out += a_stride)
+            format_local(l_local[j], a_layout, out);
+    }
+}
+
+} // namespace time
+
+} // namespace neutx
+
+#endif // _NEUTX_TIME_TIMESTAMP_HPP_
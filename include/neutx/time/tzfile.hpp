@@ -0,0 +1,384 @@
+// ex: ts=4 sw=4 ft=cpp et indentexpr=
+/**
+ * \file
+ * \brief compiled timezone (TZif) file reader
+ *
+ * Reads TZif files (RFC 8536, versions 1 to 4) as installed in
+ * /usr/share/zoneinfo, including the POSIX TZ string footer describing
+ * transitions after the last one listed in the file. Lets tzdata be
+ * built without setting TZ and probing the libc for every transition.
+ *
+ * \author Dmitriy Kargapolov
+ * \since 19 October 2026
+ *
+ */
+
+/*
+ * Copyright (C) 2026 Dmitriy Kargapolov <dmitriy.kargapolov@gmail.com>
+ * Use, modification and distribution are subject to the Boost Software
+ * License, Version 1.0 (See accompanying file LICENSE_1_0.txt or copy
+ * at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef _NEUTX_TIME_TZFILE_HPP_
+#define _NEUTX_TIME_TZFILE_HPP_
+
+#include <neutx/time/civil.hpp>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <stdexcept>
+#include <stdint.h>
+#include <string.h>
+
+namespace neutx {
+
+namespace time {
+
+// local time type
+struct tz_type {
+    long utoff;  // seconds east of UTC
+    bool isdst;  // is daylight saving on
+};
+
+// switch to local time type at given UTC time
+struct tz_transition {
+    time_t t;
+    tz_type type;
+};
+
+class tzfile {
+    // POSIX TZ rule date: Jn, n or Mm.w.d
+    struct rule_date {
+        char kind;  // 'J', 'D' or 'M'
+        int day, week, month;
+        long time;  // local time of transition, seconds
+    };
+
+    std::vector<time_t> m_times;  // transition times
+    std::vector<tz_type> m_types; // types set by transitions
+    tz_type m_initial;            // type before the first transition
+
+    // footer rule
+    bool m_has_rule;
+    bool m_has_dst;
+    tz_type m_std, m_dst;
+    rule_date m_start, m_end;
+
+    // gregorian year of the day since Epoch
+    static long year(long z) {
+        long y; unsigned m, d;
+        civil_from_days(z, y, m, d);
+        return y;
+    }
+
+    static long floor_div(time_t a, long b) {
+        return (long)(a >= 0 ? a / b : -((-a + b - 1) / b));
+    }
+
+    static bool is_leap(long y) {
+        return y % 400 == 0 || (y % 4 == 0 && y % 100 != 0);
+    }
+
+    static int64_t be(const unsigned char *p, int n) {
+        uint64_t v = 0;
+        for (int i = 0; i < n; ++i)
+            v = (v << 8) | p[i];
+        // sign extend
+        if (n < 8 && (v & ((uint64_t)1 << (n * 8 - 1))))
+            v |= ~(uint64_t)0 << (n * 8);
+        return (int64_t)v;
+    }
+
+    static void bad_file(const char *what) {
+        throw std::runtime_error(std::string("tzfile: ") + what);
+    }
+
+    void parse(const unsigned char *p, size_t size) {
+        if (size < 44 || memcmp(p, "TZif", 4) != 0)
+            bad_file("bad magic");
+        int tsize = 4;
+        const unsigned char *end = p + size;
+        // v1 header and data block, skipped if v2+ data present
+        for (;;) {
+            if (end - p < 44)
+                bad_file("truncated header");
+            char version = p[4];
+            long isutcnt = be(p + 20, 4), isstdcnt = be(p + 24, 4);
+            long leapcnt = be(p + 28, 4), timecnt = be(p + 32, 4);
+            long typecnt = be(p + 36, 4), charcnt = be(p + 40, 4);
+            if (isutcnt < 0 || isstdcnt < 0 || leapcnt < 0 || timecnt < 0 ||
+                    typecnt <= 0 || charcnt < 0)
+                bad_file("bad header counts");
+            p += 44;
+            long len = timecnt * tsize + timecnt + typecnt * 6 + charcnt +
+                leapcnt * (tsize + 4) + isstdcnt + isutcnt;
+            if (end - p < len)
+                bad_file("truncated data");
+            if (tsize == 4 && version >= '2') {
+                p += len;
+                tsize = 8;
+                continue;
+            }
+            if (leapcnt > 0)
+                bad_file("leap seconds not supported");
+            const unsigned char *idx = p + timecnt * tsize;
+            const unsigned char *tt = idx + timecnt;
+            std::vector<tz_type> types(typecnt);
+            for (long i = 0; i < typecnt; ++i) {
+                types[i].utoff = (long)be(tt + i * 6, 4);
+                types[i].isdst = tt[i * 6 + 4] != 0;
+            }
+            m_times.resize(timecnt);
+            m_types.resize(timecnt);
+            for (long i = 0; i < timecnt; ++i) {
+                m_times[i] = (time_t)be(p + i * tsize, tsize);
+                if (idx[i] >= typecnt)
+                    bad_file("bad type index");
+                if (i > 0 && m_times[i] <= m_times[i - 1])
+                    bad_file("unsorted transitions");
+                m_types[i] = types[idx[i]];
+            }
+            // same as libc: first standard time type, or first type
+            m_initial = types[0];
+            for (long i = 0; i < typecnt; ++i)
+                if (!types[i].isdst) {
+                    m_initial = types[i];
+                    break;
+                }
+            p += len;
+            break;
+        }
+        // footer
+        if (tsize == 8 && p < end) {
+            if (*p++ != '\n')
+                bad_file("bad footer");
+            const unsigned char *nl = std::find(p, end, '\n');
+            if (nl == end)
+                bad_file("bad footer");
+            parse_rule(std::string((const char *)p, nl - p));
+        }
+    }
+
+    // TZ string parser helpers
+    static bool name(const char *&s) {
+        const char *b = s;
+        if (*s == '<') {
+            while (*s && *s != '>')
+                ++s;
+            if (*s != '>')
+                return false;
+            ++s;
+            return true;
+        }
+        while ((*s >= 'A' && *s <= 'Z') || (*s >= 'a' && *s <= 'z'))
+            ++s;
+        return s - b >= 3;
+    }
+
+    static bool num(const char *&s, long& v) {
+        if (*s < '0' || *s > '9')
+            return false;
+        for (v = 0; *s >= '0' && *s <= '9'; ++s)
+            v = v * 10 + (*s - '0');
+        return true;
+    }
+
+    // [+-]hh[:mm[:ss]]
+    static bool hms(const char *&s, long& v) {
+        long sign = 1, h, m = 0, sec = 0;
+        if (*s == '+' || *s == '-')
+            sign = *s++ == '-' ? -1 : 1;
+        if (!num(s, h))
+            return false;
+        if (*s == ':') {
+            ++s;
+            if (!num(s, m))
+                return false;
+            if (*s == ':') {
+                ++s;
+                if (!num(s, sec))
+                    return false;
+            }
+        }
+        v = sign * (h * 3600 + m * 60 + sec);
+        return true;
+    }
+
+    static bool date(const char *&s, rule_date& d) {
+        if (*s == 'M') {
+            long m, w, wd;
+            ++s;
+            if (!num(s, m) || *s++ != '.' || !num(s, w) || *s++ != '.' ||
+                    !num(s, wd) || m < 1 || m > 12 || w < 1 || w > 5 ||
+                    wd > 6)
+                return false;
+            d.kind = 'M'; d.month = m; d.week = w; d.day = wd;
+        } else {
+            long n;
+            d.kind = *s == 'J' ? 'J' : 'D';
+            if (*s == 'J')
+                ++s;
+            if (!num(s, n) || n > 365 || (d.kind == 'J' && n < 1))
+                return false;
+            d.day = n;
+        }
+        d.time = 7200;
+        if (*s == '/') {
+            ++s;
+            return hms(s, d.time);
+        }
+        return true;
+    }
+
+    void parse_rule(const std::string& a_rule) {
+        m_has_rule = false;
+        m_has_dst = false;
+        if (a_rule.empty())
+            return;
+        const char *s = a_rule.c_str();
+        long off;
+        if (!name(s) || !hms(s, off))
+            bad_file("bad TZ string");
+        m_std.utoff = -off;
+        m_std.isdst = false;
+        m_has_rule = true;
+        if (!*s)
+            return;
+        if (!name(s))
+            bad_file("bad TZ string");
+        m_has_dst = true;
+        m_dst.utoff = m_std.utoff + 3600;
+        m_dst.isdst = true;
+        if (*s && *s != ',') {
+            if (!hms(s, off))
+                bad_file("bad TZ string");
+            m_dst.utoff = -off;
+        }
+        if (!*s) {
+            // no rule - POSIX leaves it to implementation, use US rule
+            const char *us = ",M3.2.0,M11.1.0";
+            s = us;
+        }
+        if (*s++ != ',' || !date(s, m_start) || *s++ != ',' ||
+                !date(s, m_end) || *s)
+            bad_file("bad TZ string");
+    }
+
+    // UTC time of rule date in given year, local time offset in effect
+    static time_t rule_time(long y, const rule_date& d, long utoff) {
+        long yday;
+        if (d.kind == 'J')
+            yday = d.day - 1 + (is_leap(y) && d.day >= 60);
+        else if (d.kind == 'D')
+            yday = d.day;
+        else {
+            static const int mdays[] =
+                {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+            long first = days_from_civil(y, d.month, 1);
+            // weekday of the first day of month, Epoch was Thursday
+            long wd = ((first + 4) % 7 + 7) % 7;
+            long md = 1 + (d.day - wd + 7) % 7 + (d.week - 1) * 7;
+            long n = mdays[d.month - 1] + (d.month == 2 && is_leap(y));
+            while (md > n)
+                md -= 7;
+            yday = first - days_from_civil(y, 1, 1) + md - 1;
+        }
+        return (time_t)(days_from_civil(y, 1, 1) + yday) * 86400 +
+            d.time - utoff;
+    }
+
+    // rule transitions of the year, chronological
+    void rule_year(long y, tz_transition (&ret)[2]) const {
+        ret[0].t = rule_time(y, m_start, m_std.utoff);
+        ret[0].type = m_dst;
+        ret[1].t = rule_time(y, m_end, m_dst.utoff);
+        ret[1].type = m_std;
+        if (ret[1].t < ret[0].t)
+            std::swap(ret[0], ret[1]);
+    }
+
+    // type set by rule at given time
+    tz_type rule_type(time_t t) const {
+        if (!m_has_dst)
+            return m_std;
+        tz_transition r[2];
+        rule_year(year(floor_div(t + m_std.utoff, 86400)), r);
+        if (t < r[0].t)
+            return r[1].type;
+        return t < r[1].t ? r[0].type : r[1].type;
+    }
+
+public:
+    // load zone by name (relative to a_dir) or absolute path
+    explicit tzfile(const char *a_zone,
+            const char *a_dir = "/usr/share/zoneinfo")
+        : m_has_rule(false), m_has_dst(false)
+    {
+        if (*a_zone == ':')
+            ++a_zone;
+        std::string path(a_zone);
+        if (*a_zone != '/')
+            path = std::string(a_dir) + "/" + path;
+        std::ifstream ifs(path.c_str(), std::ios::in | std::ios::binary);
+        std::stringstream ss;
+        ss << ifs.rdbuf();
+        if (!ifs)
+            bad_file(("can't read " + path).c_str());
+        std::string data = ss.str();
+        parse((const unsigned char *)data.data(), data.size());
+    }
+
+    // parse TZif image in memory
+    tzfile(const void *a_data, size_t a_size)
+        : m_has_rule(false), m_has_dst(false)
+    {
+        parse((const unsigned char *)a_data, a_size);
+    }
+
+    // local time type in effect at given UTC time
+    tz_type type_at(time_t t) const {
+        if (m_times.empty() || t < m_times.front())
+            return m_initial;
+        if (t >= m_times.back() && m_has_rule)
+            return rule_type(t);
+        size_t i = std::upper_bound(m_times.begin(), m_times.end(), t) -
+            m_times.begin();
+        return m_types[i - 1];
+    }
+
+    // append transitions at times lo < t <= hi, chronological
+    void transitions(time_t lo, time_t hi,
+            std::vector<tz_transition>& ret) const {
+        size_t i = std::upper_bound(m_times.begin(), m_times.end(), lo) -
+            m_times.begin();
+        for (; i < m_times.size() && m_times[i] <= hi; ++i) {
+            tz_transition tr = { m_times[i], m_types[i] };
+            ret.push_back(tr);
+        }
+        // as in libc, rule applies after the last transition only
+        if (!m_has_dst || m_times.empty())
+            return;
+        time_t from = std::max(lo, m_times.back());
+        if (from >= hi)
+            return;
+        for (long y = year(floor_div(from, 86400)) - 1,
+                y2 = year(floor_div(hi, 86400)) + 1; y <= y2; ++y) {
+            tz_transition r[2];
+            rule_year(y, r);
+            for (int k = 0; k < 2; ++k)
+                if (r[k].t > from && r[k].t <= hi &&
+                        (ret.empty() || r[k].t > ret.back().t))
+                    ret.push_back(r[k]);
+        }
+    }
+};
+
+} // namespace time
+
+} // namespace neutx
+
+#endif // _NEUTX_TIME_TZFILE_HPP_
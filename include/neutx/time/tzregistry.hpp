@@ -0,0 +1,155 @@
+// ex: ts=4 sw=4 ft=cpp et indentexpr=
+/**
+ * \file
+ * \brief registry of shared timezone data
+ *
+ * Maps zone names to small integer ids once, then gives access to the
+ * zone's tzdata by id without string hashing or locking. Each tzdata is
+ * built from the compiled zone file on first use, distinct zones may be
+ * built by different threads at the same time, instances are immutable
+ * and shared by all users of the registry.
+ *
+ * \author Dmitriy Kargapolov
+ * \since 19 October 2026
+ *
+ */
+
+/*
+ * Copyright (C) 2026 Dmitriy Kargapolov <dmitriy.kargapolov@gmail.com>
+ * Use, modification and distribution are subject to the Boost Software
+ * License, Version 1.0 (See accompanying file LICENSE_1_0.txt or copy
+ * at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef _NEUTX_TIME_TZREGISTRY_HPP_
+#define _NEUTX_TIME_TZREGISTRY_HPP_
+
+#include <neutx/time/timeconv.hpp>
+#include <neutx/time/tzfile.hpp>
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <functional>
+#include <map>
+#include <string>
+#include <stdexcept>
+
+namespace neutx {
+
+namespace time {
+
+class tzregistry {
+public:
+    // zone identifier, dense, assigned in registration order
+    typedef uint32_t zone_id;
+
+private:
+    enum {
+        chunk_bits = 8,
+        chunk_size = 1 << chunk_bits,
+        max_chunks = 256
+    };
+
+    struct entry {
+        std::string name;
+        std::atomic<const tzdata *> data;
+        std::once_flag once;
+        entry() : data(0) {}
+    };
+
+    // entries never move, chunk table is read without locking
+    std::atomic<entry *> m_chunks[max_chunks];
+    std::atomic<zone_id> m_size;
+    std::map<std::string, zone_id> m_ids;
+    std::mutex m_mutex;
+
+    int m_y1, m_y2;
+    std::string m_dir;
+
+    // prevent copying
+    tzregistry(const tzregistry&);
+    tzregistry& operator=(const tzregistry&);
+
+    entry& at(zone_id a_id) const {
+        if (a_id >= m_size.load(std::memory_order_acquire))
+            throw std::out_of_range("tzregistry: bad zone id");
+        entry *c = m_chunks[a_id >> chunk_bits].load(
+            std::memory_order_acquire);
+        return c[a_id & (chunk_size - 1)];
+    }
+
+    entry& at_unchecked(zone_id a_id) const {
+        return m_chunks[a_id >> chunk_bits].load(
+            std::memory_order_relaxed)[a_id & (chunk_size - 1)];
+    }
+
+    void build(entry& e) const {
+        const tzdata *l_data = new tzdata(m_y1, m_y2,
+            tzfile(e.name.c_str(), m_dir.c_str()));
+        e.data.store(l_data, std::memory_order_release);
+    }
+
+public:
+    // zones are built for [y1, y2) years interval
+    // from compiled zone files found in given directory
+    tzregistry(int y1, int y2, const char *a_dir = "/usr/share/zoneinfo")
+        : m_size(0), m_y1(y1), m_y2(y2), m_dir(a_dir)
+    {
+        for (int i = 0; i < max_chunks; ++i)
+            m_chunks[i].store(0, std::memory_order_relaxed);
+    }
+
+    ~tzregistry() {
+        zone_id n = m_size.load(std::memory_order_relaxed);
+        for (zone_id i = 0; i < n; ++i)
+            delete at(i).data.load(std::memory_order_relaxed);
+        for (int i = 0; i < max_chunks; ++i)
+            delete[] m_chunks[i].load(std::memory_order_relaxed);
+    }
+
+    // id of the zone, registering the name if needed; zone file is not
+    // read here, so unknown zone name fails on first get()
+    zone_id id(const std::string& a_name) {
+        std::lock_guard<std::mutex> l_lock(m_mutex);
+        std::map<std::string, zone_id>::const_iterator it =
+            m_ids.find(a_name);
+        if (it != m_ids.end())
+            return it->second;
+        zone_id l_id = m_size.load(std::memory_order_relaxed);
+        if (l_id >= (zone_id)chunk_size * max_chunks)
+            throw std::length_error("tzregistry: too many zones");
+        std::atomic<entry *>& c = m_chunks[l_id >> chunk_bits];
+        if (!c.load(std::memory_order_relaxed))
+            c.store(new entry[chunk_size], std::memory_order_release);
+        at_unchecked(l_id).name = a_name;
+        m_ids.insert(std::make_pair(a_name, l_id));
+        m_size.store(l_id + 1, std::memory_order_release);
+        return l_id;
+    }
+
+    // timezone data by id, built on first access
+    const tzdata& get(zone_id a_id) const {
+        entry& e = at(a_id);
+        const tzdata *l_data = e.data.load(std::memory_order_acquire);
+        if (!l_data) {
+            std::call_once(e.once, &tzregistry::build, this, std::ref(e));
+            l_data = e.data.load(std::memory_order_acquire);
+        }
+        return *l_data;
+    }
+
+    // timezone data by name
+    const tzdata& get(const std::string& a_name) { return get(id(a_name)); }
+
+    // name of the zone
+    const std::string& name(zone_id a_id) const { return at(a_id).name; }
+
+    // number of registered zones
+    zone_id size() const { return m_size.load(std::memory_order_acquire); }
+};
+
+} // namespace time
+
+} // namespace neutx
+
+#endif // _NEUTX_TIME_TZREGISTRY_HPP_
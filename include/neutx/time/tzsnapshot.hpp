@@ -0,0 +1,228 @@
+// ex: ts=4 sw=4 ft=cpp et indentexpr=
+/**
+ * \file
+ * \brief memory mapped snapshot of timezone data
+ *
+ * tzsnapshot_writer stores lookup arrays of a set of named tzdata
+ * instances into a flat file, tzsnapshot maps the file read-only and
+ * gives tzdata instances referring to the mapped arrays. Opening the
+ * snapshot costs one mmap and no parsing, worker processes mapping the
+ * same file share its pages through the page cache.
+ *
+ * File layout is detail::flat_dir_writer one: zone arrays, names,
+ * directory of zone records sorted by name, header, header offset. The
+ * arrays are stored in native format, the header records the sizes of
+ * the array elements so the file is rejected on incompatible platform.
+ *
+ * \author Dmitriy Kargapolov
+ * \since 19 October 2026
+ *
+ */
+
+/*
+ * Copyright (C) 2026 Dmitriy Kargapolov <dmitriy.kargapolov@gmail.com>
+ * Use, modification and distribution are subject to the Boost Software
+ * License, Version 1.0 (See accompanying file LICENSE_1_0.txt or copy
+ * at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef _NEUTX_TIME_TZSNAPSHOT_HPP_
+#define _NEUTX_TIME_TZSNAPSHOT_HPP_
+
+#include <neutx/time/timeconv.hpp>
+#include <neutx/container/detail/flat_directory.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+namespace neutx {
+
+namespace time {
+
+namespace detail {
+
+// snapshot of switch_index
+struct tzsnap_index {
+    int64_t  base;
+    int32_t  shift;
+    uint32_t span;
+    uint64_t size;
+    uint64_t nbuckets;
+    uint64_t times;    // offset of size + span times
+    uint64_t buckets;  // offset of nbuckets positions
+};
+
+// snapshot of tzdata
+struct tzsnap_zone {
+    uint64_t name;     // offset of NUL terminated zone name
+    int64_t  lotime;
+    int64_t  hitime;
+    int64_t  switch_t;
+    int64_t  def_offset;
+    uint32_t def_is_dst;
+    uint32_t pad;
+    tzsnap_index lindex;
+    tzsnap_index uindex;
+    uint64_t lpoints;  // offset of lindex.size shift points
+    uint64_t uoffsets; // offset of uindex.size local offsets
+};
+
+static const char tzsnap_magic[8] = "NTXTZS1";
+
+} // namespace detail
+
+class tzsnapshot_writer {
+    container::detail::flat_dir_writer<detail::tzsnap_zone> m_file;
+
+    // prevent copying
+    tzsnapshot_writer(const tzsnapshot_writer&);
+    tzsnapshot_writer& operator=(const tzsnapshot_writer&);
+
+    uint64_t put(const void *a_data, size_t a_size) {
+        return m_file.put(a_data, a_size);
+    }
+
+    detail::tzsnap_index put(const switch_index& a_index) {
+        detail::tzsnap_index r;
+        memset(&r, 0, sizeof(r));
+        r.base = a_index.base();
+        r.shift = a_index.shift();
+        r.span = a_index.span();
+        r.size = a_index.size();
+        r.nbuckets = a_index.buckets().size();
+        r.times = put(a_index.times().data(),
+            a_index.times().size() * sizeof(time_t));
+        r.buckets = put(a_index.buckets().data(),
+            a_index.buckets().size() * sizeof(uint32_t));
+        return r;
+    }
+
+public:
+    tzsnapshot_writer(const char *a_fname)
+        : m_file(a_fname, "tzsnapshot_writer")
+    {}
+
+    // add zone data under given name
+    void add(const std::string& a_name, const tzdata& a_data) {
+        m_file.check(a_name);
+        detail::tzsnap_zone z;
+        memset(&z, 0, sizeof(z));
+        z.lotime = a_data.m_lotime;
+        z.hitime = a_data.m_hitime;
+        z.switch_t = a_data.m_switch_t;
+        z.def_offset = a_data.m_def_offset;
+        z.def_is_dst = a_data.m_def_is_dst;
+        z.lindex = put(a_data.m_lindex);
+        z.uindex = put(a_data.m_uindex);
+        z.lpoints = put(a_data.m_lpoints.data(),
+            a_data.m_lpoints.size() * sizeof(tzdata::shift_point));
+        z.uoffsets = put(a_data.m_uoffsets.data(),
+            a_data.m_uoffsets.size() * sizeof(tzdata::loc_offset));
+        m_file.add(a_name, z);
+    }
+
+    // write directory and header, the file is not valid before that
+    void commit() { m_file.commit(detail::tzsnap_magic, abi()); }
+
+    // element sizes of the native arrays
+    static uint32_t abi() {
+        return sizeof(time_t) | sizeof(tzdata::shift_point) << 8 |
+            sizeof(tzdata::loc_offset) << 16;
+    }
+};
+
+namespace { namespace bip = boost::interprocess; }
+
+class tzsnapshot {
+    typedef container::detail::flat_dir_reader<detail::tzsnap_zone>
+        dir_t;
+
+    bip::file_mapping  m_fmap;
+    bip::mapped_region m_reg;
+    dir_t              m_dir;
+    std::vector<tzdata> m_data;
+
+    // prevent copying
+    tzsnapshot(const tzsnapshot&);
+    tzsnapshot& operator=(const tzsnapshot&);
+
+    template<typename T>
+    const T *array(uint64_t a_off, uint64_t a_count) const {
+        return m_dir.template array<T>(a_off, a_count);
+    }
+
+    // index content is checked too: lookups take shift as shift count
+    // and read span times from each bucket position
+    void attach(switch_index& a_index, const detail::tzsnap_index& s) const {
+        if (s.size && (s.nbuckets == 0 ||
+                s.shift < switch_index::min_shift || s.shift > 63))
+            throw std::runtime_error("tzsnapshot: bad index");
+        const uint32_t *b = array<uint32_t>(s.buckets,
+            s.size ? s.nbuckets : 0);
+        for (uint64_t i = 0; s.size && i < s.nbuckets; ++i)
+            if (b[i] > s.size || (i > 0 && b[i] < b[i - 1]))
+                throw std::runtime_error("tzsnapshot: bad index");
+        a_index.attach(s.base, s.shift, s.span, s.size,
+            array<time_t>(s.times, s.size ? s.size + s.span : 0),
+            b, s.nbuckets);
+    }
+
+    void load() {
+        m_data.reserve(m_dir.size());
+        for (size_t i = 0; i < m_dir.size(); ++i) {
+            const detail::tzsnap_zone& z = m_dir.entry(i);
+            tzdata d;
+            d.m_lotime = z.lotime;
+            d.m_hitime = z.hitime;
+            d.m_switch_t = z.switch_t;
+            d.m_def_offset = z.def_offset;
+            d.m_def_is_dst = z.def_is_dst;
+            attach(d.m_lindex, z.lindex);
+            attach(d.m_uindex, z.uindex);
+            d.m_lpoints.attach(array<tzdata::shift_point>(z.lpoints,
+                z.lindex.size), z.lindex.size);
+            d.m_uoffsets.attach(array<tzdata::loc_offset>(z.uoffsets,
+                z.uindex.size), z.uindex.size);
+            m_data.push_back(d);
+        }
+    }
+
+public:
+    tzsnapshot(const char *a_fname)
+        : m_fmap(a_fname, bip::read_only)
+        , m_reg(m_fmap, bip::read_only)
+        , m_dir(m_reg.get_address(), m_reg.get_size(), detail::tzsnap_magic,
+            tzsnapshot_writer::abi(), "tzsnapshot")
+    {
+        load();
+    }
+
+    // number of zones
+    size_t size() const { return m_data.size(); }
+
+    // zone data by index, zones are ordered by name
+    const tzdata& get(size_t i) const {
+        if (i >= m_data.size())
+            throw std::out_of_range("tzsnapshot: bad zone index");
+        return m_data[i];
+    }
+
+    // zone name by index
+    const char *name(size_t i) const { return m_dir.name(i); }
+
+    // zone data by name or null if not found
+    const tzdata *find(const char *a_name) const {
+        size_t i = m_dir.find(a_name);
+        return i < m_data.size() ? &m_data[i] : 0;
+    }
+};
+
+} // namespace time
+
+} // namespace neutx
+
+#endif // _NEUTX_TIME_TZSNAPSHOT_HPP_
@@ -18,14 +18,20 @@
 #include <neutx/container/detail/pnode_ss_ro.hpp>
 #include <neutx/container/ptrie.hpp>
 #include <neutx/container/mmap_ptrie.hpp>
+#include <neutx/container/mmap_da_trie.hpp>
 #include <neutx/container/detail/simple_node_store.hpp>
 #include <neutx/container/detail/flat_data_store.hpp>
 #include <neutx/container/detail/svector.hpp>
 #include <neutx/container/detail/sarray.hpp>
 #include <neutx/container/detail/file_store.hpp>
 #include <neutx/container/detail/default_ptrie_codec.hpp>
+#include <neutx/container/detail/double_array.hpp>
 
 #include <set>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iterator>
 #include <boost/numeric/conversion/cast.hpp>
 
 #include <boost/test/unit_test.hpp>
@@ -126,6 +132,16 @@ struct f1 {
         typedef dt::sarray<addr_type>::encoder coll_encoder;
         typedef dt::mmap_trie_codec::bind<addr_type>::encoder trie_encoder;
     };
+
+    // double-array export
+    struct da_encoder_t {
+        typedef offset_t addr_type;
+        typedef dt::da_trie_codec::bind<addr_type> codec;
+        typedef codec::store<dt::file_store<addr_type> >::type store_type;
+        typedef encoder<addr_type> data_encoder;
+        typedef codec::coll_encoder coll_encoder;
+        typedef codec::encoder trie_encoder;
+    };
 };
 
 struct f2 {
@@ -139,6 +155,8 @@ struct f2 {
     typedef dt::mmap_trie_codec::bind<offset_t>::root_finder root_f;
     typedef ct::mmap_ptrie<node_t, root_f> trie_t;
     typedef trie_t::store_t store_t;
+    typedef ct::mmap_da_trie<offset_t, root_f> da_trie_t;
+    typedef da_trie_t::store_t da_store_t;
 
     // fold functor to gather matched tags
     static
@@ -153,6 +171,16 @@ struct f2 {
         return true;
     }
 
+    // same for double-array trie
+    static
+    bool da_lookup(ret_t& ret, offset_t off, const da_store_t& store,
+            uint32_t, uint32_t, bool) {
+        if (off == da_store_t::null)
+            return true;
+        ret.push_back(&store.native_pointer<data>(off)->str[0]);
+        return true;
+    }
+
     // fold functor to find first match
     static bool find_first(const data*& ret, offset_t off, const store_t& store,
             uint32_t, uint32_t, bool) {
@@ -237,7 +265,7 @@ BOOST_FIXTURE_TEST_CASE( random_test, f0 )
     }
     trie.make_links();
 
-    BOOST_TEST_MESSAGE( "querying actrie agains random strings" );
+    BOOST_TEST_MESSAGE( "querying actrie against random strings" );
 
     // looking for tags in random strings
     for (int i=0; i<NSAMPLES; ++i) {
@@ -283,9 +311,35 @@ BOOST_FIXTURE_TEST_CASE( prepare_and_write_test, f1 )
     trie.make_links();
 
     BOOST_TEST_MESSAGE( "writing actrie to file" );
-    encoder_t::store_type store("test-actrie.bin");
-    encoder_t encoder;
-    trie.store_trie(encoder, store);
+    {
+        encoder_t::store_type store("test-actrie.bin");
+        encoder_t encoder;
+        trie.store_trie(encoder, store);
+    }
+
+    BOOST_TEST_MESSAGE( "writing double-array actrie to file" );
+    {
+        da_encoder_t::store_type da_store("test-actrie-da.bin");
+        da_encoder_t da_encoder;
+        trie.store_trie(da_encoder, da_store);
+    }
+
+    BOOST_TEST_MESSAGE( "writing actrie to file in parallel" );
+    {
+        encoder_t::store_type store("test-actrie-par.bin");
+        encoder_t encoder;
+        trie.store_trie_parallel(encoder, store, 4);
+    }
+
+    // suffix links across subtrees are the same
+    std::ifstream ifs1("test-actrie.bin", std::ifstream::binary);
+    std::ifstream ifs2("test-actrie-par.bin", std::ifstream::binary);
+    std::string img1((std::istreambuf_iterator<char>(ifs1)),
+        std::istreambuf_iterator<char>());
+    std::string img2((std::istreambuf_iterator<char>(ifs2)),
+        std::istreambuf_iterator<char>());
+    BOOST_REQUIRE(img1.size() > 1);
+    BOOST_REQUIRE(img1 == img2);
 }
 
 BOOST_FIXTURE_TEST_CASE( mmap_test, f2 )
@@ -298,7 +352,7 @@ BOOST_FIXTURE_TEST_CASE( mmap_test, f2 )
     for (int i=0; i<NTAGS; ++i)
         tags.insert(make_number<4>());
 
-    BOOST_TEST_MESSAGE( "querying mmap_actrie agains random strings" );
+    BOOST_TEST_MESSAGE( "querying mmap_actrie against random strings" );
 
     // looking for tags in random strings
     for (int i=0; i<NSAMPLES; ++i) {
@@ -331,6 +385,25 @@ BOOST_FIXTURE_TEST_CASE( mmap_test, f2 )
     }
 }
 
+BOOST_FIXTURE_TEST_CASE( mmap_da_test, f2 )
+{
+    trie_t trie("test-actrie.bin");
+    da_trie_t da_trie("test-actrie-da.bin");
+
+    BOOST_TEST_MESSAGE( "querying double-array actrie against random strings" );
+
+    // same matches as in sarray layout
+    srand(2);
+    for (int i=0; i<NSAMPLES; ++i) {
+        ret_t ret, exp;
+        const char *num = make_number<15>();
+        trie.fold_full(num, exp, lookup);
+        da_trie.fold_full(num, ret, da_lookup);
+        BOOST_REQUIRE_EQUAL_COLLECTIONS ( ret.begin(), ret.end(),
+                exp.begin(), exp.end() );
+    }
+}
+
 #if defined HAVE_BOOST_CHRONO
 
 BOOST_FIXTURE_TEST_CASE( chrono_mmap_test, f2 )
@@ -387,6 +460,42 @@ BOOST_FIXTURE_TEST_CASE( chrono_mmap_test_2, f2 )
         << duration_cast<nanoseconds>(d).count() << " ns" );
 }
 
+BOOST_FIXTURE_TEST_CASE( chrono_mmap_da_test, f2 )
+{
+    trie_t trie("test-actrie.bin");
+    da_trie_t da_trie("test-actrie-da.bin");
+
+    // same random strings folded through both layouts
+    std::vector<std::string> nums;
+    srand(2);
+    for (int i=0; i<NSAMPLES; ++i)
+        nums.push_back(make_number<15>());
+
+    BOOST_TEST_MESSAGE( "measuring sarray vs double-array full lookup time" );
+
+    size_t n1 = 0, n2 = 0;
+    time_point tp1 = clock::now();
+    for (int i=0; i<NSAMPLES; ++i) {
+        ret_t ret;
+        trie.fold_full(nums[i].c_str(), ret, lookup);
+        n1 += ret.size();
+    }
+    duration d1 = (clock::now() - tp1) / NSAMPLES;
+
+    time_point tp2 = clock::now();
+    for (int i=0; i<NSAMPLES; ++i) {
+        ret_t ret;
+        da_trie.fold_full(nums[i].c_str(), ret, da_lookup);
+        n2 += ret.size();
+    }
+    duration d2 = (clock::now() - tp2) / NSAMPLES;
+
+    BOOST_REQUIRE_EQUAL(n1, n2);
+    BOOST_TEST_MESSAGE( "mmap_actrie full lookup time: sarray "
+        << duration_cast<nanoseconds>(d1).count() << " ns, double-array "
+        << duration_cast<nanoseconds>(d2).count() << " ns" );
+}
+
 #endif // HAVE_BOOST_CHRONO
 
 BOOST_AUTO_TEST_SUITE_END()
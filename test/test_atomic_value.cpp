@@ -12,11 +12,52 @@
  * at http://www.boost.org/LICENSE_1_0.txt)
  */
 
+#include <config.h>
 #include <neutx/atomic_value.hpp>
+#include <neutx/sharded_counter.hpp>
+#include <neutx/memstat_alloc.hpp>
+#include <neutx/object_id.hpp>
+#include <algorithm>
 #include <boost/test/unit_test.hpp>
+#include <thread>
+#include <vector>
+
+#if defined HAVE_BOOST_CHRONO
+#include <boost/chrono/system_clocks.hpp>
+#endif
 
 using namespace neutx::atomic;
 
+// memstat_alloc counter policy backed by single atomic_value
+template<int N>
+struct atomic_memstat {
+    static void inc(size_t n) { cnt.fetch_add(n, std::memory_order_relaxed); }
+    static void dec(size_t n) { cnt.fetch_sub(n, std::memory_order_relaxed); }
+    static long get() { return cnt.get(); }
+    static atomic_value<long> cnt;
+};
+
+template<int N>
+atomic_value<long> atomic_memstat<N>::cnt;
+
+// allocate and free n blocks of various size with allocator A
+template<typename A>
+void alloc_loop(int n) {
+    A a;
+    for (int i = 0; i < n; ++i)
+        a.deallocate(a.allocate(16 + i % 64), 16 + i % 64);
+}
+
+// run alloc_loop in given number of threads
+template<typename A>
+void alloc_threads(int nthreads, int n) {
+    std::vector<std::thread> threads;
+    for (int k = 0; k < nthreads; ++k)
+        threads.push_back(std::thread(&alloc_loop<A>, n));
+    for (int k = 0; k < nthreads; ++k)
+        threads[k].join();
+}
+
 BOOST_AUTO_TEST_SUITE( test_atomic_value )
 
 BOOST_AUTO_TEST_CASE( single_thread_ops )
@@ -41,4 +82,135 @@ BOOST_AUTO_TEST_CASE( single_thread_ops )
     BOOST_REQUIRE_EQUAL(a & 7, 5);
 }
 
+BOOST_AUTO_TEST_CASE( memory_order_ops )
+{
+    atomic_value<long> a;
+    BOOST_REQUIRE_EQUAL(a.fetch_add(5, std::memory_order_relaxed), 0);
+    BOOST_REQUIRE_EQUAL(a.fetch_sub(2, std::memory_order_relaxed), 5);
+    BOOST_REQUIRE_EQUAL(a.get(std::memory_order_relaxed), 3);
+    BOOST_REQUIRE_EQUAL(a.exchange(10, std::memory_order_acq_rel), 3);
+    long e = 9;
+    BOOST_REQUIRE(!a.compare_exchange_strong(e, 11,
+        std::memory_order_release));
+    BOOST_REQUIRE_EQUAL(e, 10);
+    while (!a.compare_exchange_weak(e, e * 2, std::memory_order_acq_rel)) ;
+    BOOST_REQUIRE_EQUAL(a.get(std::memory_order_acquire), 20);
+    a.set(1, std::memory_order_release);
+    a.bset(6, std::memory_order_relaxed);
+    a.bclear(2, std::memory_order_relaxed);
+    BOOST_REQUIRE_EQUAL(a.get(), 5);
+    atomic_value<long> b = a;
+    BOOST_REQUIRE_EQUAL(b.get(), 5);
+}
+
+BOOST_AUTO_TEST_CASE( concurrent_ops )
+{
+    const int nthreads = 4, niters = 100000;
+    atomic_value<long> cnt, max;
+    atomic_value<int> ready;
+    long data = 0;
+    std::vector<std::thread> threads;
+    for (int k = 0; k < nthreads; ++k)
+        threads.push_back(std::thread([&, k]() {
+            for (int i = 0; i < niters; ++i) {
+                long v = cnt.fetch_add(1, std::memory_order_relaxed) + 1;
+                long m = max.get(std::memory_order_relaxed);
+                while (m < v && !max.compare_exchange_weak(m, v,
+                        std::memory_order_relaxed)) ;
+            }
+            // publish data written before release store
+            if (k == 0) {
+                data = 42;
+                ready.set(1, std::memory_order_release);
+            }
+        }));
+    while (!ready.get(std::memory_order_acquire)) ;
+    BOOST_REQUIRE_EQUAL(data, 42);
+    for (int k = 0; k < nthreads; ++k)
+        threads[k].join();
+    BOOST_REQUIRE_EQUAL(cnt.get(), (long)nthreads * niters);
+    BOOST_REQUIRE_EQUAL(max.get(), (long)nthreads * niters);
+}
+
+BOOST_AUTO_TEST_CASE( sharded_counter_ops )
+{
+    neutx::sharded_counter<long, 4> cnt;
+    std::vector<std::thread> threads;
+    for (int k = 0; k < 8; ++k)
+        threads.push_back(std::thread([&cnt, k]() {
+            for (int i = 0; i < 10000; ++i) {
+                cnt.add(k + 2);
+                cnt.sub(1);
+            }
+        }));
+    for (int k = 0; k < 8; ++k)
+        threads[k].join();
+    BOOST_REQUIRE_EQUAL(cnt.get(), 10000L * (8 * 9 / 2));
+    cnt.reset();
+    BOOST_REQUIRE_EQUAL(cnt.get(), 0);
+
+    typedef neutx::memstat_alloc<char, neutx::sharded_memstat<char> > alloc;
+    alloc_threads<alloc>(4, 1000);
+    BOOST_REQUIRE_EQUAL(neutx::sharded_memstat<char>::get(), 0);
+    alloc a;
+    char *p = a.allocate(100);
+    BOOST_REQUIRE_EQUAL(neutx::sharded_memstat<char>::get(), 100);
+    a.deallocate(p, 100);
+    BOOST_REQUIRE_EQUAL(neutx::sharded_memstat<char>::get(), 0);
+}
+
+struct tagged : neutx::block_object_id<tagged, unsigned, 16> {};
+
+BOOST_AUTO_TEST_CASE( block_object_id_test )
+{
+    const int nthreads = 4, nobjs = 1000;
+    std::vector<unsigned> ids[nthreads];
+    std::vector<std::thread> threads;
+    for (int k = 0; k < nthreads; ++k)
+        threads.push_back(std::thread([&ids, k]() {
+            for (int i = 0; i < nobjs; ++i)
+                ids[k].push_back(tagged().oid());
+        }));
+    for (int k = 0; k < nthreads; ++k)
+        threads[k].join();
+    std::vector<unsigned> all;
+    for (int k = 0; k < nthreads; ++k) {
+        // increasing within a thread
+        for (int i = 1; i < nobjs; ++i)
+            BOOST_REQUIRE(ids[k][i] > ids[k][i - 1]);
+        all.insert(all.end(), ids[k].begin(), ids[k].end());
+    }
+    // unique, no more than one partly used block per thread
+    std::sort(all.begin(), all.end());
+    BOOST_REQUIRE(std::adjacent_find(all.begin(), all.end()) == all.end());
+    BOOST_REQUIRE_EQUAL(all.front(), 1u);
+    BOOST_REQUIRE(all.back() <= (unsigned)(nthreads * (nobjs + 16)));
+}
+
+#if defined HAVE_BOOST_CHRONO
+BOOST_AUTO_TEST_CASE( memstat_scaling_test )
+{
+    typedef boost::chrono::high_resolution_clock clock;
+    typedef neutx::memstat_alloc<char, atomic_memstat<0> > atomic_alloc;
+    typedef neutx::memstat_alloc<char, neutx::sharded_memstat<int> >
+        sharded_alloc;
+    const int n = 1000000;
+    for (int t = 1; t <= 8; t *= 2) {
+        clock::time_point tp0 = clock::now();
+        alloc_threads<atomic_alloc>(t, n);
+        clock::duration d0 = clock::now() - tp0;
+        clock::time_point tp1 = clock::now();
+        alloc_threads<sharded_alloc>(t, n);
+        clock::duration d1 = clock::now() - tp1;
+        BOOST_REQUIRE_EQUAL(atomic_memstat<0>::get(), 0);
+        BOOST_REQUIRE_EQUAL(neutx::sharded_memstat<int>::get(), 0);
+        BOOST_TEST_MESSAGE( "memstat_alloc " << t << " threads, "
+            "allocate/deallocate per second: atomic "
+            << (long)(1e9 * n * t / boost::chrono::nanoseconds(d0).count())
+            << ", sharded "
+            << (long)(1e9 * n * t / boost::chrono::nanoseconds(d1).count()));
+    }
+}
+#endif
+
 BOOST_AUTO_TEST_SUITE_END()
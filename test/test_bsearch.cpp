@@ -0,0 +1,227 @@
+// ex: ts=4 sw=4 ft=cpp et indentexpr=
+/**
+ * \file
+ * \brief test cases for search algorithms
+ *
+ * \author Dmitriy Kargapolov
+ * \since 19 October 2026
+ *
+ * Copyright (C) 2026 Dmitriy Kargapolov <dmitriy.kargapolov@gmail.com>
+ * Use, modification and distribution are subject to the Boost Software
+ * License, Version 1.0 (See accompanying file LICENSE_1_0.txt or copy
+ * at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <config.h>
+#include <neutx/algorithm/bsearch.hpp>
+#include <neutx/algorithm/eytzinger.hpp>
+#include <neutx/algorithm/static_search.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#if defined HAVE_BOOST_CHRONO
+#include <boost/chrono/system_clocks.hpp>
+#endif
+
+#include <algorithm>
+#include <vector>
+#include <stdint.h>
+#include <stdlib.h>
+
+namespace bsearch_test {
+
+namespace na = neutx::algorithm;
+
+#if defined HAVE_BOOST_CHRONO
+typedef boost::chrono::high_resolution_clock clock;
+typedef clock::time_point time_point;
+typedef clock::duration duration;
+using boost::chrono::nanoseconds;
+using boost::chrono::duration_cast;
+#endif
+
+#define NSAMPLES 1000000
+
+// sorted array of n random values with duplicates
+template<typename S>
+std::vector<S> make_table(size_t n) {
+    std::vector<S> v(n);
+    for (size_t i = 0; i < n; ++i)
+        v[i] = (S)(rand() % (4 * n + 1)) - (S)n;
+    std::sort(v.begin(), v.end());
+    return v;
+}
+
+// position of the first element greater than t or n
+template<typename S>
+size_t expected(const std::vector<S>& v, S t) {
+    return std::upper_bound(v.begin(), v.end(), t) - v.begin();
+}
+
+template<typename S>
+size_t pos(const std::vector<S>& v, const S *p) {
+    return p ? p - &v[0] : v.size();
+}
+
+template<typename S>
+void check_search(size_t n) {
+    std::vector<S> v = make_table<S>(n);
+    na::eytzinger_array<S> e(v.begin(), v.end());
+    BOOST_REQUIRE_EQUAL(e.size(), n);
+    for (size_t i = 0; i < n; ++i)
+        BOOST_REQUIRE_EQUAL(e[i], v[i]);
+    for (int i = -3 * (int)n - 2; i < 3 * (int)n + 2; ++i) {
+        S t = (S)i;
+        size_t x = expected(v, t);
+        const S *p = v.empty() ? 0 : &v[0];
+        BOOST_REQUIRE_EQUAL(pos(v, na::bsearch(p, n, t)), x);
+        BOOST_REQUIRE_EQUAL(pos(v, na::lsearch(p, n, t)), x);
+        const S *q = e.upper_bound(t);
+        BOOST_REQUIRE_EQUAL(q ? e.rank(q) : n, x);
+        if (q)
+            BOOST_REQUIRE_EQUAL(*q, v[x]);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE( test_bsearch )
+
+BOOST_AUTO_TEST_CASE( search_test )
+{
+    srand(1);
+    for (size_t n = 0; n < 70; ++n) {
+        check_search<int32_t>(n);
+        check_search<int64_t>(n);
+        check_search<double>(n);
+    }
+    check_search<int32_t>(1000);
+    check_search<int64_t>(1023);
+    check_search<int64_t>(1024);
+}
+
+BOOST_AUTO_TEST_CASE( batch_search_test )
+{
+    srand(1);
+    const size_t sizes[] = { 0, 1, 2, 3, 17, 1000, 65536, 100000 };
+    for (size_t k = 0; k < sizeof(sizes) / sizeof(sizes[0]); ++k) {
+        size_t n = sizes[k];
+        std::vector<int64_t> v = make_table<int64_t>(n);
+        int64_t *p = v.empty() ? 0 : &v[0];
+        std::vector<int64_t> q(1000);
+        for (size_t i = 0; i < q.size(); ++i)
+            q[i] = rand() % (6 * n + 3) - 3 * (int64_t)n - 1;
+        std::vector<int64_t *> out(q.size());
+        for (int sorted = 0; sorted < 2; ++sorted) {
+            if (sorted)
+                std::sort(q.begin(), q.end());
+            na::bsearch(p, n, &q[0], q.size(), &out[0]);
+            for (size_t i = 0; i < q.size(); ++i)
+                BOOST_REQUIRE_EQUAL(pos(v, out[i]), expected(v, q[i]));
+        }
+    }
+}
+
+constexpr int bands[] = { -5, 0, 0, 3, 10, 25, 50, 100, 250, 1000, 1000 };
+constexpr na::static_search<int, 11> band_tree(bands);
+
+static_assert(band_tree.upper_bound_index(-6) == 0, "before all");
+static_assert(band_tree.upper_bound_index(0) == 3, "duplicates");
+static_assert(band_tree.upper_bound_index(99) == 7, "inside");
+static_assert(band_tree.upper_bound_index(1000) == 11, "after all");
+
+template<size_t N>
+void check_static(const int64_t (&a)[N]) {
+    na::static_search<int64_t, N> tree(a);
+    std::vector<int64_t> v(a, a + N);
+    BOOST_REQUIRE_EQUAL(tree.size(), N);
+    for (int64_t t = a[0] - 2; t <= a[N - 1] + 2; ++t)
+        BOOST_REQUIRE_EQUAL(pos(v, na::bsearch(&v[0], N, t)) ,
+            tree.upper_bound_index(t));
+    BOOST_REQUIRE_EQUAL(tree.upper_bound_index(INT64_MAX), N);
+    BOOST_REQUIRE(tree.upper_bound(INT64_MAX) == 0);
+    BOOST_REQUIRE_EQUAL(*tree.upper_bound(a[0] - 1), a[0]);
+}
+
+BOOST_AUTO_TEST_CASE( static_search_test )
+{
+    for (int t = -10; t < 1010; ++t) {
+        const int *p = band_tree.upper_bound(t);
+        size_t x = std::upper_bound(bands, bands + 11, t) - bands;
+        BOOST_REQUIRE_EQUAL(p ? (size_t)(p - &band_tree[0]) : 11u, x);
+    }
+    const int64_t a1[] = { 7 };
+    const int64_t a2[] = { 1, 2 };
+    const int64_t a7[] = { 1, 3, 5, 7, 9, 11, 13 };
+    const int64_t a8[] = { 1, 3, 5, 7, 9, 11, 13, 15 };
+    const int64_t a9[] = { -3, -3, -3, 0, 1, 1, 2, 40, 41 };
+    check_static(a1);
+    check_static(a2);
+    check_static(a7);
+    check_static(a8);
+    check_static(a9);
+    const int64_t bad[] = { 1, 3, 2 };
+    BOOST_REQUIRE_THROW(check_static(bad), std::invalid_argument);
+}
+
+#if defined HAVE_BOOST_CHRONO
+BOOST_AUTO_TEST_CASE( search_time_test )
+{
+    srand(1);
+    for (size_t n = 1 << 10; n <= (1 << 22); n <<= 4) {
+        std::vector<int32_t> v = make_table<int32_t>(n);
+        na::eytzinger_array<int32_t> e(v.begin(), v.end());
+        std::vector<int32_t> q(NSAMPLES);
+        for (int i = 0; i < NSAMPLES; ++i)
+            q[i] = rand() % (4 * n) - n;
+
+        // sums keep the calls from being optimized out
+        size_t s0 = 0, s1 = 0;
+
+        time_point tp0 = clock::now();
+        for (int i = 0; i < NSAMPLES; ++i)
+            s0 += pos(v, na::bsearch(&v[0], n, q[i]));
+        duration d0 = (clock::now() - tp0) / NSAMPLES;
+
+        time_point tp1 = clock::now();
+        for (int i = 0; i < NSAMPLES; ++i) {
+            const int32_t *p = e.upper_bound(q[i]);
+            s1 += p ? *p : n;
+        }
+        duration d1 = (clock::now() - tp1) / NSAMPLES;
+
+        std::vector<int32_t *> out(NSAMPLES);
+        time_point tp2 = clock::now();
+        na::bsearch(&v[0], n, &q[0], NSAMPLES, &out[0]);
+        duration d2 = (clock::now() - tp2) / NSAMPLES;
+        size_t s3 = 0;
+        for (int i = 0; i < NSAMPLES; ++i)
+            s3 += pos(v, out[i]);
+
+        std::sort(q.begin(), q.end());
+        time_point tp3 = clock::now();
+        na::bsearch(&v[0], n, &q[0], NSAMPLES, &out[0]);
+        duration d3 = (clock::now() - tp3) / NSAMPLES;
+
+        size_t s2 = 0;
+        for (int i = 0; i < NSAMPLES; ++i) {
+            size_t x = expected(v, q[i]);
+            s2 += x < n ? v[x] : n;
+            BOOST_REQUIRE_EQUAL(pos(v, out[i]), x);
+        }
+        BOOST_REQUIRE_EQUAL(s0, s3);
+        BOOST_REQUIRE_EQUAL(s1, s2);
+
+        BOOST_TEST_MESSAGE( n << " elements, bsearch() time: "
+            << duration_cast<nanoseconds>(d0).count() << " ns, "
+            << "eytzinger_array time: "
+            << duration_cast<nanoseconds>(d1).count() << " ns, "
+            << "batch time: "
+            << duration_cast<nanoseconds>(d2).count() << " ns, "
+            << "sorted batch time: "
+            << duration_cast<nanoseconds>(d3).count() << " ns" );
+    }
+}
+#endif
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace bsearch_test
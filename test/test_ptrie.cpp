@@ -20,9 +20,17 @@
 #include <neutx/container/detail/simple_node_store.hpp>
 #include <neutx/container/detail/flat_data_store.hpp>
 #include <neutx/container/detail/svector.hpp>
+#include <neutx/container/detail/cow_svector.hpp>
+#include <neutx/container/detail/epoch_node_store.hpp>
 #include <neutx/container/detail/sarray.hpp>
 #include <neutx/container/detail/file_store.hpp>
 #include <neutx/container/detail/default_ptrie_codec.hpp>
+#include <neutx/container/detail/dedup_codec.hpp>
+#include <neutx/container/digit_trie.hpp>
+#include <neutx/container/trie_pack.hpp>
+#include <neutx/container/trie_stream.hpp>
+#include <neutx/container/trie_merge.hpp>
+#include <neutx/container/trie_overlay.hpp>
 #include <neutx/memstat_alloc.hpp>
 
 #include <boost/test/unit_test.hpp>
@@ -31,8 +39,14 @@
 #include <boost/chrono/system_clocks.hpp>
 #endif
 
+#include <boost/interprocess/anonymous_shared_memory.hpp>
 #include <boost/unordered_map.hpp>
+#include <fstream>
+#include <iterator>
 #include <map>
+#include <memory>
+#include <atomic>
+#include <thread>
 
 namespace ptrie_test {
 
@@ -233,6 +247,124 @@ struct f2 {
     }
 };
 
+struct f3 : f1 {
+    // f1 data encoder in form of public codec
+    struct codec {
+        template<typename AddrType>
+        struct bind {
+            typedef AddrType data_type;
+            typedef data::encoder<AddrType> encoder;
+        };
+    };
+
+    typedef ct::digit_trie<data> types;
+    typedef types::encoder_type<codec> plain_encoder_t;
+    typedef types::encoder_type<dt::dedup_codec<codec> > dedup_encoder_t;
+    typedef types::encoder_type<codec, dt::louds_trie_codec> louds_encoder_t;
+    typedef ct::digit_mmap_trie<codec, ct::Trie_Normal, uint32_t,
+        dt::louds_trie_codec> louds_types;
+    typedef types::encoder_type<codec, dt::da_trie_codec> da_encoder_t;
+    typedef ct::digit_mmap_trie<codec, ct::Trie_Normal, uint32_t,
+        dt::da_trie_codec> da_types;
+
+    static std::streamoff file_size(const char *fname) {
+        std::ifstream ifs(fname, std::ifstream::binary | std::ifstream::ate);
+        return ifs.tellg();
+    }
+
+    // payload of the node found by left_bound() or empty string
+    static std::string left_bound(const f2::trie_t& trie, const char *key) {
+        std::pair<bool, const f2::node_t*> ret = trie.left_bound(key);
+        if (!ret.second || ret.second->data() == f2::store_t::null)
+            return std::string();
+        const f2::data *ptr =
+            trie.store().native_pointer<f2::data>(ret.second->data());
+        return std::string(ptr->m_str, ptr->m_len);
+    }
+
+    template<typename Trie>
+    static std::string left_bound(const Trie& trie, const char *key) {
+        std::pair<bool, typename Trie::node_t> ret = trie.left_bound(key);
+        if (!ret.second || ret.second->data() == f2::store_t::null)
+            return std::string();
+        const f2::data *ptr =
+            trie.store().template native_pointer<f2::data>(ret.second->data());
+        return std::string(ptr->m_str, ptr->m_len);
+    }
+
+    // fold functors for any store type
+    template<typename Store>
+    static bool copy_exact_f(std::string &acc, offset_t off,
+            const Store& store, uint32_t, bool has_next) {
+        if (has_next || off == Store::null)
+            return true;
+        const f2::data *ptr = store.template native_pointer<f2::data>(off);
+        acc.assign(ptr->m_str, ptr->m_len);
+        return false;
+    }
+
+    template<typename Store>
+    static bool lookup_simple(const f2::data*& ret, offset_t off,
+            const Store& store, uint32_t, bool) {
+        if (off != Store::null)
+            ret = store.template native_pointer<f2::data>(off);
+        return true;
+    }
+
+    // collect all key-payload pairs of the trie
+    typedef std::map<std::string, std::string> dump_t;
+
+    template<typename Node, typename Store>
+    struct dump_f {
+        dump_t& m_dump;
+        dump_f(dump_t& a_dump) : m_dump(a_dump) {}
+        void operator()(const std::string& key, const Node& node,
+                const Store& store) {
+            if (node.data() == Store::null)
+                return;
+            const f2::data *ptr =
+                store.template native_pointer<f2::data>(node.data());
+            m_dump[key].assign(ptr->m_str, ptr->m_len);
+        }
+    };
+};
+
+struct f4 {
+    // payload assigned atomically by writer
+    struct data {
+        std::atomic<uint32_t> m_val;
+        data() : m_val(0) {}
+        data& operator=(uint32_t a_val) {
+            m_val.store(a_val, std::memory_order_release);
+            return *this;
+        }
+        uint32_t get() const { return m_val.load(std::memory_order_acquire); }
+    };
+
+    // trie readable while updated
+    typedef dt::pnode<dt::epoch_node_store<>, data, dt::cow_svector<> >
+        node_t;
+    typedef ct::ptrie<node_t> trie_t;
+    typedef trie_t::store_t store_t;
+
+    enum { nkeys = 100000, nreaders = 4 };
+
+    // i-th key
+    static std::string key(int i) {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%07d", (int)(i * 7919LL % 10000000));
+        return buf;
+    }
+
+    // fold functor to get payload of exact match
+    static bool get_exact(uint32_t& ret, const data& d, const store_t&,
+            uint32_t, bool has_next) {
+        if (!has_next)
+            ret = d.get();
+        return true;
+    }
+};
+
 BOOST_AUTO_TEST_SUITE( test_ptrie )
 
 BOOST_FIXTURE_TEST_CASE( write_read_test, f0 )
@@ -407,6 +539,818 @@ BOOST_FIXTURE_TEST_CASE( mmap_test, f2 )
     BOOST_TEST_MESSAGE( l_total << " full strings matched" );
 }
 
+BOOST_FIXTURE_TEST_CASE( dedup_export_test, f3 )
+{
+    static const char *tariffs[] = { "tariff-a", "tariff-b", "tariff-c" };
+    const int ntariffs = sizeof(tariffs) / sizeof(tariffs[0]);
+
+    int l_total = NSAMPLES / 10;
+    srand(1);
+    types::trie_type l_trie;
+    for (int i=0; i<l_total; ++i)
+        l_trie.store(make_number<5>(), data(tariffs[i % ntariffs]));
+
+    {
+        plain_encoder_t::file_store store("test-trie-plain.bin");
+        plain_encoder_t encoder;
+        BOOST_REQUIRE_NO_THROW(( l_trie.store_trie(encoder, store) ));
+    }
+
+    dedup_encoder_t encoder;
+    {
+        dedup_encoder_t::file_store store("test-trie-dedup.bin");
+        BOOST_REQUIRE_NO_THROW(( l_trie.store_trie(encoder, store) ));
+    }
+    BOOST_REQUIRE_EQUAL((size_t)ntariffs, encoder.data_state().size());
+
+    std::streamoff l_plain = file_size("test-trie-plain.bin");
+    std::streamoff l_dedup = file_size("test-trie-dedup.bin");
+    BOOST_TEST_MESSAGE( "plain size: " << l_plain << ", dedup size: "
+        << l_dedup << ", saved: " << encoder.data_state().saved() );
+    BOOST_REQUIRE_EQUAL(l_plain - l_dedup,
+        (std::streamoff)encoder.data_state().saved());
+
+    // both files must give same lookup results
+    f2::trie_t l_plain_trie("test-trie-plain.bin");
+    f2::trie_t l_dedup_trie("test-trie-dedup.bin");
+    srand(1);
+    for (int i=0; i<l_total; ++i) {
+        const char *l_num = make_number<5>();
+        std::string l_ret1, l_ret2;
+        l_plain_trie.fold(l_num, l_ret1, f2::copy_exact_f);
+        l_dedup_trie.fold(l_num, l_ret2, f2::copy_exact_f);
+        BOOST_REQUIRE_EQUAL(l_ret1, l_ret2);
+        BOOST_REQUIRE(!l_ret2.empty());
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE( dag_export_test, f3 )
+{
+    static const char *tariffs[] = { "tariff-a", "tariff-b", "tariff-c" };
+    const int ntariffs = sizeof(tariffs) / sizeof(tariffs[0]);
+
+    // full fan-outs under random prefixes, sharing payloads
+    int l_total = NSAMPLES / 100;
+    srand(1);
+    types::trie_type l_trie;
+    for (int i=0; i<l_total; ++i) {
+        std::string l_num = make_number<3>();
+        for (char c = '0'; c <= '9'; ++c)
+            l_trie.store(l_num + c, data(tariffs[(c - '0') % ntariffs]));
+    }
+
+    {
+        plain_encoder_t::file_store store("test-trie-tree.bin");
+        plain_encoder_t encoder;
+        BOOST_REQUIRE_NO_THROW(( l_trie.store_trie(encoder, store) ));
+    }
+    {
+        plain_encoder_t::file_store store("test-trie-dag.bin");
+        plain_encoder_t encoder;
+        BOOST_REQUIRE_NO_THROW(( l_trie.store_dag(encoder, store) ));
+    }
+
+    std::streamoff l_tree = file_size("test-trie-tree.bin");
+    std::streamoff l_dag = file_size("test-trie-dag.bin");
+    BOOST_TEST_MESSAGE( "tree size: " << l_tree << ", dag size: " << l_dag );
+    BOOST_REQUIRE(l_dag < l_tree);
+
+    // both files must give same lookup results
+    f2::trie_t l_tree_trie("test-trie-tree.bin");
+    f2::trie_t l_dag_trie("test-trie-dag.bin");
+    srand(123);
+    for (int i=0; i<NSAMPLES / 10; ++i) {
+        const char *l_num = make_number<3>();
+        std::string l_ret1, l_ret2;
+        l_tree_trie.fold(l_num, l_ret1, f2::copy_exact_f);
+        l_dag_trie.fold(l_num, l_ret2, f2::copy_exact_f);
+        BOOST_REQUIRE_EQUAL(l_ret1, l_ret2);
+        BOOST_REQUIRE_EQUAL(left_bound(l_tree_trie, l_num),
+            left_bound(l_dag_trie, l_num));
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE( louds_export_test, f3 )
+{
+    int l_total = NSAMPLES / 10;
+    srand(1);
+    types::trie_type l_trie;
+    for (int i=0; i<l_total; ++i) {
+        const char *l_num = make_number<5>();
+        l_trie.store(l_num, data(l_num));
+    }
+
+    {
+        plain_encoder_t::file_store store("test-trie-sarray.bin");
+        plain_encoder_t encoder;
+        BOOST_REQUIRE_NO_THROW(( l_trie.store_trie(encoder, store) ));
+    }
+    {
+        louds_encoder_t::file_store store("test-trie-louds.bin");
+        louds_encoder_t encoder;
+        BOOST_REQUIRE_NO_THROW(( l_trie.store_trie(encoder, store) ));
+    }
+
+    f2::trie_t l_sarray_trie("test-trie-sarray.bin");
+    louds_types::trie_type l_louds_trie("test-trie-louds.bin");
+    BOOST_REQUIRE_EQUAL(l_trie.store().count(), l_louds_trie.size());
+
+    std::streamoff l_sarray = file_size("test-trie-sarray.bin");
+    std::streamoff l_louds = file_size("test-trie-louds.bin");
+    BOOST_TEST_MESSAGE( "sarray size: " << l_sarray << ", louds size: "
+        << l_louds << ", nodes: " << l_louds_trie.size() );
+    BOOST_REQUIRE(l_louds < l_sarray);
+
+    // same lookup results
+    srand(123);
+    for (int i=0; i<NSAMPLES / 10; ++i) {
+        const char *l_num = make_number<5>();
+        std::string l_ret1, l_ret2;
+        l_sarray_trie.fold(l_num, l_ret1, f2::copy_exact_f);
+        l_louds_trie.fold(l_num, l_ret2,
+            copy_exact_f<louds_types::store_type>);
+        BOOST_REQUIRE_EQUAL(l_ret1, l_ret2);
+        const f2::data *l_ptr1 = 0, *l_ptr2 = 0;
+        l_sarray_trie.fold(l_num, l_ptr1, f2::lookup_simple);
+        l_louds_trie.fold(l_num, l_ptr2,
+            lookup_simple<louds_types::store_type>);
+        BOOST_REQUIRE_EQUAL(l_ptr1 == 0, l_ptr2 == 0);
+        if (l_ptr1)
+            BOOST_REQUIRE_EQUAL(std::string(l_ptr1->m_str, l_ptr1->m_len),
+                std::string(l_ptr2->m_str, l_ptr2->m_len));
+        BOOST_REQUIRE_EQUAL(left_bound(l_sarray_trie, l_num),
+            left_bound(l_louds_trie, l_num));
+    }
+
+    // same content
+    dump_t l_dump1, l_dump2;
+    l_sarray_trie.foreach<ct::down, std::string>(
+        dump_f<f2::node_t, f2::store_t>(l_dump1));
+    l_louds_trie.foreach<ct::down, std::string>(
+        dump_f<louds_types::node_type, louds_types::store_type>(l_dump2));
+    BOOST_REQUIRE_EQUAL(l_dump1.size(), l_dump2.size());
+    BOOST_REQUIRE(l_dump1 == l_dump2);
+}
+
+BOOST_FIXTURE_TEST_CASE( da_export_test, f3 )
+{
+    int l_total = NSAMPLES / 10;
+    srand(1);
+    types::trie_type l_trie;
+    for (int i=0; i<l_total; ++i) {
+        const char *l_num = make_number<5>();
+        l_trie.store(l_num, data(l_num));
+    }
+
+    {
+        plain_encoder_t::file_store store("test-trie-sarray.bin");
+        plain_encoder_t encoder;
+        BOOST_REQUIRE_NO_THROW(( l_trie.store_trie(encoder, store) ));
+    }
+    {
+        da_encoder_t::file_store store("test-trie-da.bin");
+        da_encoder_t encoder;
+        BOOST_REQUIRE_NO_THROW(( l_trie.store_trie(encoder, store) ));
+    }
+
+    f2::trie_t l_sarray_trie("test-trie-sarray.bin");
+    da_types::trie_type l_da_trie("test-trie-da.bin");
+    BOOST_REQUIRE(l_da_trie.size() >= l_trie.store().count());
+    BOOST_TEST_MESSAGE( "units: " << l_da_trie.size() << ", nodes: "
+        << l_trie.store().count() );
+
+    // same lookup results
+    srand(123);
+    for (int i=0; i<NSAMPLES / 10; ++i) {
+        const char *l_num = make_number<5>();
+        std::string l_ret1, l_ret2;
+        l_sarray_trie.fold(l_num, l_ret1, f2::copy_exact_f);
+        l_da_trie.fold(l_num, l_ret2, copy_exact_f<da_types::store_type>);
+        BOOST_REQUIRE_EQUAL(l_ret1, l_ret2);
+        BOOST_REQUIRE_EQUAL(left_bound(l_sarray_trie, l_num),
+            left_bound(l_da_trie, l_num));
+    }
+
+    // same content
+    dump_t l_dump1, l_dump2;
+    l_sarray_trie.foreach<ct::down, std::string>(
+        dump_f<f2::node_t, f2::store_t>(l_dump1));
+    l_da_trie.foreach<ct::down, std::string>(
+        dump_f<da_types::node_type, da_types::store_type>(l_dump2));
+    BOOST_REQUIRE(l_dump1 == l_dump2);
+}
+
+BOOST_FIXTURE_TEST_CASE( pack_export_test, f3 )
+{
+    typedef ct::trie_pack_writer<offset_t> writer_t;
+    typedef types::encoder_type<codec, dt::mmap_trie_codec,
+        writer_t::store_type> pack_encoder_t;
+    typedef types::encoder_type<codec, dt::louds_trie_codec,
+        writer_t::store_type> pack_louds_encoder_t;
+    typedef ct::trie_pack<offset_t> pack_t;
+
+    static const char *names[] = { "plan-c", "plan-a", "plan-b" };
+    const int ntries = sizeof(names) / sizeof(names[0]);
+
+    srand(1);
+    types::trie_type l_tries[ntries];
+    for (int k=0; k<ntries; ++k)
+        for (int i=0; i<NSAMPLES / 100; ++i) {
+            const char *l_num = make_number<4>();
+            l_tries[k].store(l_num, data(l_num));
+        }
+
+    {
+        writer_t l_writer("test-trie-pack.bin");
+        for (int k=0; k<ntries; ++k) {
+            pack_encoder_t encoder;
+            BOOST_REQUIRE_NO_THROW(( l_writer.add(names[k], l_tries[k],
+                encoder) ));
+        }
+        pack_louds_encoder_t encoder;
+        BOOST_REQUIRE_NO_THROW(( l_writer.add("plan-louds", l_tries[0],
+            encoder) ));
+        BOOST_REQUIRE_THROW(( l_writer.add("plan-a", l_tries[0], encoder) ),
+            std::invalid_argument);
+        l_writer.commit();
+    }
+
+    pack_t l_pack("test-trie-pack.bin");
+    BOOST_REQUIRE_EQUAL(l_pack.size(), (size_t)ntries + 1);
+    BOOST_REQUIRE_EQUAL(std::string(l_pack.name(0)), "plan-a");
+    BOOST_REQUIRE_EQUAL(l_pack.find("plan-x"), l_pack.size());
+    BOOST_REQUIRE_THROW(l_pack.region("plan-x"), std::out_of_range);
+
+    // views give same results as tries exported to own files
+    for (int k=0; k<ntries; ++k) {
+        {
+            plain_encoder_t::file_store store("test-trie-sarray.bin");
+            plain_encoder_t encoder;
+            BOOST_REQUIRE_NO_THROW(( l_tries[k].store_trie(encoder, store) ));
+        }
+        f2::trie_t l_file_trie("test-trie-sarray.bin");
+        pack_t::region_t r = l_pack.region(names[k]);
+        f2::trie_t l_view(r.first, r.second);
+
+        srand(123);
+        for (int i=0; i<NSAMPLES / 100; ++i) {
+            const char *l_num = make_number<4>();
+            std::string l_ret1, l_ret2;
+            l_file_trie.fold(l_num, l_ret1, f2::copy_exact_f);
+            l_view.fold(l_num, l_ret2, f2::copy_exact_f);
+            BOOST_REQUIRE_EQUAL(l_ret1, l_ret2);
+            BOOST_REQUIRE_EQUAL(left_bound(l_file_trie, l_num),
+                left_bound(l_view, l_num));
+        }
+
+        dump_t l_dump1, l_dump2;
+        l_file_trie.foreach<ct::down, std::string>(
+            dump_f<f2::node_t, f2::store_t>(l_dump1));
+        l_view.foreach<ct::down, std::string>(
+            dump_f<f2::node_t, f2::store_t>(l_dump2));
+        BOOST_REQUIRE(!l_dump1.empty());
+        BOOST_REQUIRE(l_dump1 == l_dump2);
+
+        if (k == 0) {
+            pack_t::region_t r = l_pack.region("plan-louds");
+            louds_types::trie_type l_louds_view(r.first, r.second);
+            dump_t l_dump3;
+            l_louds_view.foreach<ct::down, std::string>(
+                dump_f<louds_types::node_type,
+                    louds_types::store_type>(l_dump3));
+            BOOST_REQUIRE(l_dump1 == l_dump3);
+        }
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE( memory_region_test, f3 )
+{
+    namespace bip = boost::interprocess;
+
+    srand(1);
+    types::trie_type l_trie;
+    for (int i=0; i<NSAMPLES / 100; ++i) {
+        const char *l_num = make_number<5>();
+        l_trie.store(l_num, data(l_num));
+    }
+    {
+        plain_encoder_t::file_store store("test-trie-sarray.bin");
+        plain_encoder_t encoder;
+        BOOST_REQUIRE_NO_THROW(( l_trie.store_trie(encoder, store) ));
+    }
+    f2::trie_t l_file_trie("test-trie-sarray.bin");
+    size_t l_size = file_size("test-trie-sarray.bin");
+
+    // image received into a buffer, trie keeps it alive
+    std::shared_ptr<std::vector<char> > l_buf(
+        new std::vector<char>(l_size));
+    std::ifstream ifs("test-trie-sarray.bin", std::ifstream::binary);
+    ifs.read(&(*l_buf)[0], l_size);
+    BOOST_REQUIRE(ifs);
+    std::shared_ptr<const void> l_owner(l_buf, &(*l_buf)[0]);
+    l_buf.reset();
+    f2::trie_t l_buf_trie(l_owner, l_size);
+    l_owner.reset();
+
+    // image in anonymous memory, trie takes the mapping over
+    bip::mapped_region l_reg(bip::anonymous_shared_memory(l_size));
+    memcpy(l_reg.get_address(), l_file_trie.store().native_pointer<char>(0),
+        l_size);
+    f2::trie_t l_anon_trie(std::move(l_reg));
+    BOOST_REQUIRE(l_reg.get_address() == 0);
+
+    dump_t l_dump1, l_dump2, l_dump3;
+    l_file_trie.foreach<ct::down, std::string>(
+        dump_f<f2::node_t, f2::store_t>(l_dump1));
+    l_buf_trie.foreach<ct::down, std::string>(
+        dump_f<f2::node_t, f2::store_t>(l_dump2));
+    l_anon_trie.foreach<ct::down, std::string>(
+        dump_f<f2::node_t, f2::store_t>(l_dump3));
+    BOOST_REQUIRE(!l_dump1.empty());
+    BOOST_REQUIRE(l_dump1 == l_dump2);
+    BOOST_REQUIRE(l_dump1 == l_dump3);
+
+    srand(123);
+    for (int i=0; i<NSAMPLES / 100; ++i) {
+        const char *l_num = make_number<5>();
+        std::string l_ret1, l_ret2;
+        l_file_trie.fold(l_num, l_ret1, f2::copy_exact_f);
+        l_buf_trie.fold(l_num, l_ret2, f2::copy_exact_f);
+        BOOST_REQUIRE_EQUAL(l_ret1, l_ret2);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE( stream_export_test, f3 )
+{
+    typedef dt::file_store<offset_t> out_t;
+    typedef ct::trie_stream_writer<plain_encoder_t, out_t, data>
+        stream_t;
+    typedef ct::trie_stream_writer<louds_encoder_t,
+        louds_encoder_t::file_store, data> louds_stream_t;
+
+    // sorted source with keys being prefixes of other keys
+    srand(1);
+    std::map<std::string, std::string> l_src;
+    l_src[""] = "root";
+    for (int i=0; i<NSAMPLES / 10; ++i) {
+        std::string l_num = make_number<3>();
+        l_src[l_num] = l_num;
+    }
+
+    types::trie_type l_trie;
+    for (std::map<std::string, std::string>::const_iterator it =
+            l_src.begin(); it != l_src.end(); ++it)
+        l_trie.store(it->first, data(it->second.c_str()));
+    {
+        plain_encoder_t::file_store store("test-trie-sarray.bin");
+        plain_encoder_t encoder;
+        BOOST_REQUIRE_NO_THROW(( l_trie.store_trie(encoder, store) ));
+    }
+    {
+        louds_encoder_t::file_store store("test-trie-louds.bin");
+        louds_encoder_t encoder;
+        BOOST_REQUIRE_NO_THROW(( l_trie.store_trie(encoder, store) ));
+    }
+
+    {
+        out_t store("test-trie-stream.bin");
+        plain_encoder_t encoder;
+        stream_t l_writer(encoder, store);
+        for (std::map<std::string, std::string>::const_iterator it =
+                l_src.begin(); it != l_src.end(); ++it)
+            l_writer.add(it->first, data(it->second.c_str()));
+        BOOST_REQUIRE_THROW(l_writer.add(std::string("5"), data("x")),
+            std::invalid_argument);
+        BOOST_REQUIRE_THROW(l_writer.add(l_src.rbegin()->first, data("x")),
+            std::invalid_argument);
+        l_writer.finish();
+    }
+    {
+        louds_encoder_t::file_store store("test-trie-louds-stream.bin");
+        louds_encoder_t encoder;
+        louds_stream_t l_writer(encoder, store);
+        for (std::map<std::string, std::string>::const_iterator it =
+                l_src.begin(); it != l_src.end(); ++it)
+            l_writer.add(it->first, data(it->second.c_str()));
+        l_writer.finish();
+    }
+
+    // images are the same byte by byte
+    const char *files[][2] = {
+        { "test-trie-sarray.bin", "test-trie-stream.bin" },
+        { "test-trie-louds.bin", "test-trie-louds-stream.bin" }
+    };
+    for (int k=0; k<2; ++k) {
+        std::ifstream ifs1(files[k][0], std::ifstream::binary);
+        std::ifstream ifs2(files[k][1], std::ifstream::binary);
+        std::string l_img1((std::istreambuf_iterator<char>(ifs1)),
+            std::istreambuf_iterator<char>());
+        std::string l_img2((std::istreambuf_iterator<char>(ifs2)),
+            std::istreambuf_iterator<char>());
+        BOOST_REQUIRE(l_img1.size() > 1);
+        BOOST_REQUIRE(l_img1 == l_img2);
+    }
+
+    // empty stream gives empty trie
+    {
+        out_t store("test-trie-stream.bin");
+        plain_encoder_t encoder;
+        stream_t l_writer(encoder, store);
+        l_writer.finish();
+        BOOST_REQUIRE_THROW(l_writer.add(std::string("1"), data("x")),
+            std::runtime_error);
+    }
+    f2::trie_t l_empty("test-trie-stream.bin");
+    dump_t l_dump;
+    l_empty.foreach<ct::down, std::string>(
+        dump_f<f2::node_t, f2::store_t>(l_dump));
+    BOOST_REQUIRE(l_dump.empty());
+}
+
+BOOST_FIXTURE_TEST_CASE( merge_export_test, f3 )
+{
+    // keeps the greatest payload of equal keys
+    struct combine_f {
+        void operator()(data& acc, const data& d) const {
+            if (acc.str < d.str)
+                acc.str = d.str;
+        }
+    };
+
+    // sorted shards with keys repeated in and across shards
+    static const char *shards[] = {
+        "test-trie-shard0.txt", "test-trie-shard1.txt", "test-trie-shard2.txt"
+    };
+    const int nshards = sizeof(shards) / sizeof(shards[0]);
+    std::vector<std::string> l_inputs(shards, shards + nshards);
+    std::map<std::string, std::string> l_expected;
+    srand(1);
+    for (int k=0; k<nshards; ++k) {
+        std::multimap<std::string, std::string> l_shard;
+        for (int i=0; i<NSAMPLES / 30; ++i) {
+            std::string l_num = make_number<3>();
+            std::string l_val = "v" + std::to_string(rand() % 100);
+            l_shard.insert(std::make_pair(l_num, l_val));
+            std::string& l_exp = l_expected[l_num];
+            l_exp = std::max(l_exp, l_val);
+        }
+        std::ofstream ofs(shards[k]);
+        for (std::multimap<std::string, std::string>::const_iterator it =
+                l_shard.begin(); it != l_shard.end(); ++it)
+            ofs << it->first << '\t' << it->second << '\n';
+    }
+
+    types::trie_type l_trie;
+    for (std::map<std::string, std::string>::const_iterator it =
+            l_expected.begin(); it != l_expected.end(); ++it)
+        l_trie.store(it->first, data(it->second.c_str()));
+    {
+        plain_encoder_t::file_store store("test-trie-sarray.bin");
+        plain_encoder_t encoder;
+        BOOST_REQUIRE_NO_THROW(( l_trie.store_trie(encoder, store) ));
+    }
+
+    plain_encoder_t encoder;
+    size_t l_count = 0;
+    BOOST_REQUIRE_NO_THROW(( l_count = ct::merge_sorted_files<data>(
+        l_inputs, "test-trie-merge.bin", encoder, combine_f(), 4096) ));
+    BOOST_REQUIRE_EQUAL(l_count, l_expected.size());
+
+    std::ifstream ifs1("test-trie-sarray.bin", std::ifstream::binary);
+    std::ifstream ifs2("test-trie-merge.bin", std::ifstream::binary);
+    std::string l_img1((std::istreambuf_iterator<char>(ifs1)),
+        std::istreambuf_iterator<char>());
+    std::string l_img2((std::istreambuf_iterator<char>(ifs2)),
+        std::istreambuf_iterator<char>());
+    BOOST_REQUIRE(l_img1 == l_img2);
+
+    // unsorted shard
+    {
+        std::ofstream ofs(shards[0]);
+        ofs << "2\tb\n1\ta\n";
+    }
+    BOOST_REQUIRE_THROW(ct::merge_sorted_files<data>(l_inputs,
+        "test-trie-merge.bin", encoder, combine_f()), std::invalid_argument);
+}
+
+BOOST_FIXTURE_TEST_CASE( overlay_test, f3 )
+{
+    // base payload in delta payload type
+    struct decode_f {
+        bool operator()(const f2::store_t& store, offset_t off,
+                data& out) const {
+            if (off == f2::store_t::null)
+                return false;
+            const f2::data *ptr = store.native_pointer<f2::data>(off);
+            out.str.assign(ptr->m_str, ptr->m_len);
+            return true;
+        }
+    };
+    typedef ct::trie_overlay<f2::trie_t, data, decode_f> overlay_t;
+    typedef std::map<std::string, std::string> model_t;
+
+    struct fold_f {
+        static bool exact(std::string& acc, const data *d, uint32_t,
+                bool has_next) {
+            if (has_next)
+                return true;
+            if (d)
+                acc = d->str;
+            return false;
+        }
+    };
+
+    struct dump_merged {
+        model_t& m_dump;
+        dump_merged(model_t& a_dump) : m_dump(a_dump) {}
+        void operator()(const std::string& key, const data *d) {
+            if (d)
+                m_dump[key] = d->str;
+        }
+    };
+
+    // ordered keys visited
+    struct keys_f {
+        std::vector<std::string>& m_keys;
+        keys_f(std::vector<std::string>& a_keys) : m_keys(a_keys) {}
+        void operator()(const std::string& key, const data *) {
+            m_keys.push_back(key);
+        }
+    };
+
+    // exports model, erased keys as nodes without payload
+    struct export_f {
+        static void run(const model_t& a_model, const char *a_fname) {
+            types::trie_type l_trie;
+            for (model_t::const_iterator it = a_model.begin();
+                    it != a_model.end(); ++it)
+                l_trie.store(it->first, data(it->second.c_str()));
+            plain_encoder_t::file_store store(a_fname);
+            plain_encoder_t encoder;
+            l_trie.store_trie(encoder, store);
+        }
+    };
+
+    srand(1);
+    model_t l_model, l_nodes;
+    for (int i=0; i<NSAMPLES / 100; ++i) {
+        std::string l_num = make_number<3>();
+        l_model[l_num] = l_nodes[l_num] = "base-" + l_num;
+    }
+    export_f::run(l_model, "test-trie-base.bin");
+
+    overlay_t l_ov("test-trie-base.bin");
+    for (int i=0; i<NSAMPLES / 1000; ++i) {
+        std::string l_num = make_number<3>();
+        if (i % 3 == 0) {
+            l_ov.erase(l_num);
+            l_model.erase(l_num);
+            l_nodes[l_num] = "";
+        } else {
+            l_ov.store(l_num, data(("delta-" + l_num).c_str()));
+            l_model[l_num] = l_nodes[l_num] = "delta-" + l_num;
+        }
+    }
+    // erase some base keys for sure
+    for (model_t::iterator it = l_model.begin(); it != l_model.end(); ) {
+        if (rand() % 50 == 0) {
+            l_ov.erase(it->first);
+            l_nodes[it->first] = "";
+            l_model.erase(it++);
+        } else
+            ++it;
+    }
+    export_f::run(l_nodes, "test-trie-sarray.bin");
+    f2::trie_t l_ref("test-trie-sarray.bin");
+
+    model_t l_dump;
+    l_ov.foreach<ct::down, std::string>(dump_merged(l_dump));
+    BOOST_REQUIRE(l_dump == l_model);
+
+    // both directions visit all nodes in the same order as plain trie
+    for (int d=0; d<2; ++d) {
+        std::vector<std::string> l_keys1, l_keys2;
+        if (d) {
+            l_ov.foreach<ct::up, std::string>(keys_f(l_keys1));
+            l_ref.foreach<ct::up, std::string>(
+                [&](const std::string& key, const f2::node_t&,
+                    const f2::store_t&) { l_keys2.push_back(key); });
+        } else {
+            l_ov.foreach<ct::down, std::string>(keys_f(l_keys1));
+            l_ref.foreach<ct::down, std::string>(
+                [&](const std::string& key, const f2::node_t&,
+                    const f2::store_t&) { l_keys2.push_back(key); });
+        }
+        BOOST_REQUIRE(l_keys1 == l_keys2);
+    }
+
+    srand(123);
+    for (int i=0; i<NSAMPLES / 10; ++i) {
+        const char *l_num = make_number<3>();
+        std::string l_ret;
+        l_ov.fold(l_num, l_ret, fold_f::exact);
+        model_t::const_iterator it = l_model.find(l_num);
+        BOOST_REQUIRE_EQUAL(l_ret, it == l_model.end() ? "" : it->second);
+        data l_data;
+        std::pair<bool, bool> l_lb = l_ov.left_bound(l_num, l_data);
+        BOOST_REQUIRE_EQUAL(l_lb.second ? l_data.str : "",
+            left_bound(l_ref, l_num));
+        BOOST_REQUIRE_EQUAL(l_lb.first, l_ref.left_bound(l_num).first);
+    }
+
+    // changes made during compaction stay in the delta
+    plain_encoder_t encoder;
+    l_ov.compact("test-trie-compact.bin", encoder);
+    BOOST_REQUIRE_THROW(l_ov.compact("test-trie-compact.bin", encoder),
+        std::runtime_error);
+    size_t l_compacted = l_model.size();
+    l_ov.store(std::string("12345"), data("late"));
+    l_model["12345"] = "late";
+    l_ov.erase(l_model.begin()->first);
+    l_model.erase(l_model.begin());
+    BOOST_REQUIRE_EQUAL(l_ov.install(), l_compacted);
+    BOOST_REQUIRE_EQUAL(l_ov.changes(), 2u);
+
+    l_dump.clear();
+    l_ov.foreach<ct::down, std::string>(dump_merged(l_dump));
+    BOOST_REQUIRE(l_dump == l_model);
+}
+
+BOOST_FIXTURE_TEST_CASE( parallel_export_test, f3 )
+{
+    typedef dt::file_store<offset_t> out_t;
+
+    types::trie_type l_trie;
+    l_trie.store(std::string(""), data("root"));
+    srand(1);
+    for (int i=0; i<NSAMPLES / 10; ++i) {
+        const char *l_num = make_number<5>();
+        l_trie.store(l_num, data(l_num));
+    }
+    {
+        out_t store("test-trie-sarray.bin");
+        plain_encoder_t encoder;
+        BOOST_REQUIRE_NO_THROW(( l_trie.store_trie(encoder, store) ));
+    }
+    const char *files[] = { "test-trie-par1.bin", "test-trie-par4.bin" };
+    const unsigned threads[] = { 1, 4 };
+    for (int k=0; k<2; ++k) {
+        out_t store(files[k]);
+        plain_encoder_t encoder;
+        BOOST_REQUIRE_NO_THROW((
+            l_trie.store_trie_parallel(encoder, store, threads[k]) ));
+    }
+
+    // images are the same byte by byte
+    std::ifstream ifs("test-trie-sarray.bin", std::ifstream::binary);
+    std::string l_img((std::istreambuf_iterator<char>(ifs)),
+        std::istreambuf_iterator<char>());
+    BOOST_REQUIRE(l_img.size() > 1);
+    for (int k=0; k<2; ++k) {
+        std::ifstream ifs1(files[k], std::ifstream::binary);
+        std::string l_img1((std::istreambuf_iterator<char>(ifs1)),
+            std::istreambuf_iterator<char>());
+        BOOST_REQUIRE(l_img == l_img1);
+    }
+
+    // empty trie, no subtrees to export
+    types::trie_type l_empty;
+    {
+        out_t store("test-trie-empty.bin");
+        plain_encoder_t encoder;
+        BOOST_REQUIRE_NO_THROW(( l_empty.store_trie(encoder, store) ));
+    }
+    {
+        out_t store("test-trie-empty-par.bin");
+        plain_encoder_t encoder;
+        BOOST_REQUIRE_NO_THROW((
+            l_empty.store_trie_parallel(encoder, store, 4) ));
+    }
+    std::ifstream ifs2("test-trie-empty.bin", std::ifstream::binary);
+    std::ifstream ifs3("test-trie-empty-par.bin", std::ifstream::binary);
+    std::string l_img2((std::istreambuf_iterator<char>(ifs2)),
+        std::istreambuf_iterator<char>());
+    std::string l_img3((std::istreambuf_iterator<char>(ifs3)),
+        std::istreambuf_iterator<char>());
+    BOOST_REQUIRE(l_img2.size() > 1);
+    BOOST_REQUIRE(l_img2 == l_img3);
+}
+
+BOOST_FIXTURE_TEST_CASE( stats_test, f3 )
+{
+    types::trie_type l_trie;
+    srand(1);
+    for (int i=0; i<NSAMPLES / 10; ++i) {
+        const char *l_num = make_number<5>();
+        l_trie.store(l_num, data(l_num));
+    }
+    ct::trie_stats l_stats = l_trie.stats();
+    BOOST_TEST_MESSAGE( l_stats );
+    BOOST_REQUIRE_EQUAL(l_stats.nodes, l_trie.store().count());
+    BOOST_REQUIRE_EQUAL(l_stats.depth.at(0), 1u);
+    size_t l_depth_sum = 0, l_fanout_sum = 0, l_edges = 0;
+    for (size_t i=0; i<l_stats.depth.size(); ++i)
+        l_depth_sum += l_stats.depth[i];
+    for (size_t i=0; i<l_stats.fanout.size(); ++i) {
+        l_fanout_sum += l_stats.fanout[i];
+        l_edges += i * l_stats.fanout[i];
+    }
+    BOOST_REQUIRE_EQUAL(l_depth_sum, l_stats.nodes);
+    BOOST_REQUIRE_EQUAL(l_fanout_sum, l_stats.nodes);
+    BOOST_REQUIRE_EQUAL(l_edges, l_stats.nodes - 1);
+    BOOST_REQUIRE(l_stats.spare_bytes <= l_stats.child_bytes);
+    BOOST_REQUIRE(l_stats.payload_bytes > 0);
+    BOOST_REQUIRE_EQUAL(l_stats.mapped_bytes, 0u);
+
+    {
+        plain_encoder_t::file_store store("test-trie-sarray.bin");
+        plain_encoder_t encoder;
+        l_trie.store_trie(encoder, store);
+    }
+    f2::trie_t l_mmap("test-trie-sarray.bin");
+    std::string l_ret;
+    l_mmap.fold(make_number<5>(), l_ret, f2::copy_exact_f);
+    ct::trie_stats l_mstats = l_mmap.stats();
+    BOOST_TEST_MESSAGE( l_mstats );
+    BOOST_REQUIRE_EQUAL(l_mstats.nodes, l_stats.nodes);
+    BOOST_REQUIRE(l_mstats.depth == l_stats.depth);
+    BOOST_REQUIRE(l_mstats.fanout == l_stats.fanout);
+    BOOST_REQUIRE_EQUAL(l_mstats.spare_bytes, 0u);
+    BOOST_REQUIRE_EQUAL(l_mstats.mapped_bytes,
+        (uint64_t)file_size("test-trie-sarray.bin"));
+    BOOST_REQUIRE(l_mstats.total_bytes() <= l_mstats.mapped_bytes);
+    BOOST_REQUIRE(l_mstats.resident_bytes > 0);
+    BOOST_REQUIRE(l_mstats.resident_bytes <= l_mstats.mapped_bytes);
+
+    // unaligned region in heap is counted within its bounds
+    std::ifstream ifs("test-trie-sarray.bin", std::ifstream::binary);
+    std::string l_img((std::istreambuf_iterator<char>(ifs)),
+        std::istreambuf_iterator<char>());
+    std::vector<char> l_buf(l_img.size() + 8);
+    memcpy(&l_buf[1], l_img.data(), l_img.size());
+    f2::trie_t l_view(&l_buf[1], l_img.size());
+    ct::trie_stats l_vstats = l_view.stats();
+    BOOST_REQUIRE_EQUAL(l_vstats.mapped_bytes, l_img.size());
+    BOOST_REQUIRE_EQUAL(l_vstats.resident_bytes, l_img.size());
+}
+
+BOOST_FIXTURE_TEST_CASE( concurrent_read_test, f4 )
+{
+    trie_t l_trie;
+    std::atomic<int> l_stored(0), l_errors(0);
+    std::atomic<bool> l_done(false);
+
+    // readers: stored key is always found with its payload,
+    // any other key is either not found or has no payload yet
+    std::vector<std::thread> l_readers;
+    for (int r=0; r<nreaders; ++r)
+        l_readers.push_back(std::thread([&, r]() {
+            unsigned l_seed = r + 1;
+            while (!l_done.load()) {
+                int l_n = l_stored.load();
+                int i = rand_r(&l_seed) % nkeys;
+                uint32_t l_ret = 0;
+                l_trie.fold(key(i), l_ret, get_exact);
+                if (i < l_n ? l_ret != (uint32_t)i + 1 :
+                        l_ret != 0 && l_ret != (uint32_t)i + 1)
+                    ++l_errors;
+            }
+        }));
+
+    for (int i=0; i<nkeys; ++i) {
+        l_trie.store(key(i), (uint32_t)i + 1);
+        l_stored.store(i + 1);
+    }
+    l_done.store(true);
+    for (int r=0; r<nreaders; ++r)
+        l_readers[r].join();
+
+    BOOST_REQUIRE_EQUAL(l_errors.load(), 0);
+    BOOST_REQUIRE_EQUAL(l_trie.store().reclaim(), 0u);
+    for (int i=0; i<nkeys; ++i) {
+        uint32_t l_ret = 0;
+        l_trie.fold(key(i), l_ret, get_exact);
+        BOOST_REQUIRE_EQUAL(l_ret, (uint32_t)i + 1);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE( reader_overflow_test, f4 )
+{
+    // readers beyond the slots hold back reclamation
+    typedef dt::epoch_node_store<void, std::allocator<char>, 2> store_t;
+    struct f { static void free(void *p) { delete (int *)p; } };
+    store_t l_store;
+    std::unique_ptr<store_t::read_guard> g1(new store_t::read_guard(l_store));
+    std::unique_ptr<store_t::read_guard> g2(new store_t::read_guard(l_store));
+    std::unique_ptr<store_t::read_guard> g3(new store_t::read_guard(l_store));
+    l_store.retire(new int(1), &f::free);
+    g1.reset();
+    g2.reset();
+    BOOST_REQUIRE_EQUAL(l_store.reclaim(), 1u);
+    g3.reset();
+    BOOST_REQUIRE_EQUAL(l_store.reclaim(), 0u);
+}
+
 #if defined HAVE_BOOST_CHRONO
 
 BOOST_FIXTURE_TEST_CASE( chrono_test, f0 )
@@ -554,6 +1498,53 @@ BOOST_FIXTURE_TEST_CASE( chrono_mmap_test_simple, f2 )
         << duration_cast<nanoseconds>(d).count() << " ns" );
 }
 
+BOOST_FIXTURE_TEST_CASE( chrono_da_test, f3 )
+{
+    srand(1);
+    types::trie_type l_trie;
+    for (int i=0; i<NSAMPLES / 10; ++i) {
+        const char *l_num = make_number<5>();
+        l_trie.store(l_num, data(l_num));
+    }
+    {
+        plain_encoder_t::file_store store("test-trie-sarray.bin");
+        plain_encoder_t encoder;
+        l_trie.store_trie(encoder, store);
+    }
+    {
+        da_encoder_t::file_store store("test-trie-da.bin");
+        da_encoder_t encoder;
+        l_trie.store_trie(encoder, store);
+    }
+    f2::trie_t l_sarray_trie("test-trie-sarray.bin");
+    da_types::trie_type l_da_trie("test-trie-da.bin");
+
+    // same keys folded through both images
+    int l_total = NSAMPLES;
+    std::vector<std::string> l_keys;
+    srand(123);
+    for (int i=0; i<l_total; ++i)
+        l_keys.push_back(make_number<5>());
+
+    const f2::data *l_ret1 = 0, *l_ret2 = 0;
+    time_point tp1 = clock::now();
+    for (int i=0; i<l_total; ++i)
+        l_sarray_trie.fold(l_keys[i].c_str(), l_ret1,
+            lookup_simple<f2::store_t>);
+    duration d1 = (clock::now() - tp1) / l_total;
+    time_point tp2 = clock::now();
+    for (int i=0; i<l_total; ++i)
+        l_da_trie.fold(l_keys[i].c_str(), l_ret2,
+            lookup_simple<da_types::store_type>);
+    duration d2 = (clock::now() - tp2) / l_total;
+    BOOST_REQUIRE(l_ret1 && l_ret2);
+    BOOST_REQUIRE_EQUAL(std::string(l_ret1->m_str, l_ret1->m_len),
+        std::string(l_ret2->m_str, l_ret2->m_len));
+    BOOST_TEST_MESSAGE( "sarray lookup time "
+        << duration_cast<nanoseconds>(d1).count() << " ns, double-array "
+        "lookup time " << duration_cast<nanoseconds>(d2).count() << " ns" );
+}
+
 #endif // HAVE_BOOST_CHRONO
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -14,9 +14,16 @@
 
 #include <config.h>
 #include <neutx/time/timeconv.hpp>
+#include <neutx/time/tzregistry.hpp>
+#include <neutx/time/tzsnapshot.hpp>
+#include <neutx/time/timestamp.hpp>
 #include <boost/numeric/conversion/cast.hpp>
 #include <boost/foreach.hpp>
 #include <fstream>
+#include <algorithm>
+#include <iterator>
+#include <cstring>
+#include <thread>
 
 #include <boost/test/unit_test.hpp>
 
@@ -68,20 +75,37 @@ struct tzdata_codec {
         long off; bool dst;
     };
 
+    // frozen content of the trees
+    static std::vector<tzdata::ltzval_t> ltree(const tzdata& tz) {
+        std::vector<tzdata::ltzval_t> v;
+        for (size_t i = 0; i < tz.m_lpoints.size(); ++i)
+            v.push_back(tzdata::ltzval_t(tz.m_lindex.times()[i],
+                tz.m_lpoints[i]));
+        return v;
+    }
+
+    static std::vector<tzdata::utzval_t> utree(const tzdata& tz) {
+        std::vector<tzdata::utzval_t> v;
+        for (size_t i = 0; i < tz.m_uoffsets.size(); ++i)
+            v.push_back(tzdata::utzval_t(tz.m_uindex.times()[i],
+                tz.m_uoffsets[i]));
+        return v;
+    }
+
     static void dump(const char *file, const tzdata& data) {
         ofile out(file);
         head h; bzero(&h, sizeof(h));
-        h.ln = data.m_ltztree.size();
-        h.un = data.m_utztree.size();
+        h.ln = data.m_lpoints.size();
+        h.un = data.m_uoffsets.size();
         h.lo = data.m_lotime;
         h.hi = data.m_hitime;
         h.sw = data.m_switch_t;
         h.off = data.m_def_offset;
         h.dst = data.m_def_is_dst;
         out.write(&h, sizeof(h));
-        BOOST_FOREACH(const tzdata::ltzval_t& v, data.m_ltztree)
+        BOOST_FOREACH(const tzdata::ltzval_t& v, ltree(data))
             out.write(&v, sizeof(v));
-        BOOST_FOREACH(const tzdata::utzval_t& v, data.m_utztree)
+        BOOST_FOREACH(const tzdata::utzval_t& v, utree(data))
             out.write(&v, sizeof(v));
     }
 
@@ -107,9 +131,37 @@ struct tzdata_codec {
             in.read(&v, sizeof(v));
             tz->m_utztree.insert(v);
         } }
+        tz->freeze();
         return tz;
     }
 
+    // compare bucket index lookups to binary search of the arrays
+    static void check_frozen(const tzdata& tz, time_t t) {
+        tzdata::shift_point p;
+        tz.offset(t, p);
+        const time_t *lt = tz.m_lindex.times().data();
+        size_t l = std::upper_bound(lt, lt + tz.m_lpoints.size(), t) - lt;
+        if (l == tz.m_lpoints.size()) {
+            BOOST_REQUIRE_EQUAL(p.t0, tz.m_switch_t);
+            BOOST_REQUIRE_EQUAL(p.off1, tz.m_def_offset);
+        } else {
+            BOOST_REQUIRE_EQUAL(p.t0, tz.m_lpoints[l].t0);
+            BOOST_REQUIRE_EQUAL(p.off1, tz.m_lpoints[l].off1);
+            BOOST_REQUIRE_EQUAL(p.off2, tz.m_lpoints[l].off2);
+        }
+        bool dst;
+        long off = tz.offset(t, dst);
+        const time_t *ut = tz.m_uindex.times().data();
+        size_t u = std::upper_bound(ut, ut + tz.m_uoffsets.size(), t) - ut;
+        if (u == tz.m_uoffsets.size()) {
+            BOOST_REQUIRE_EQUAL(off, tz.m_def_offset);
+            BOOST_REQUIRE_EQUAL(dst, tz.m_def_is_dst);
+        } else {
+            BOOST_REQUIRE_EQUAL(off, tz.m_uoffsets[u].offset);
+            BOOST_REQUIRE_EQUAL(dst, tz.m_uoffsets[u].is_dst);
+        }
+    }
+
     static time_t lotime(const tzdata& tz) { return tz.m_lotime; }
     static time_t hitime(const tzdata& tz) { return tz.m_hitime; }
 
@@ -119,14 +171,13 @@ struct tzdata_codec {
         BOOST_REQUIRE_EQUAL(t1.m_switch_t, t2.m_switch_t);
         BOOST_REQUIRE_EQUAL(t1.m_def_offset, t2.m_def_offset);
         BOOST_REQUIRE_EQUAL(t1.m_def_is_dst, t2.m_def_is_dst);
-        BOOST_REQUIRE_EQUAL_COLLECTIONS(
-            t1.m_ltztree.begin(), t1.m_ltztree.end(),
-            t2.m_ltztree.begin(), t2.m_ltztree.end()
-        );
-        BOOST_REQUIRE_EQUAL_COLLECTIONS(
-            t1.m_utztree.begin(), t1.m_utztree.end(),
-            t2.m_utztree.begin(), t2.m_utztree.end()
-        );
+        std::vector<tzdata::ltzval_t> l1 = ltree(t1), l2 = ltree(t2);
+        std::vector<tzdata::utzval_t> u1 = utree(t1), u2 = utree(t2);
+        BOOST_REQUIRE_EQUAL_COLLECTIONS(l1.begin(), l1.end(),
+            l2.begin(), l2.end());
+        BOOST_REQUIRE_EQUAL_COLLECTIONS(u1.begin(), u1.end(),
+            u2.begin(), u2.end());
+        BOOST_REQUIRE(t1.m_ltztree.empty() && t1.m_utztree.empty());
     }
 
     typedef tzdata::ltzval_t shiftp_t;
@@ -329,7 +380,522 @@ BOOST_FIXTURE_TEST_CASE( massive_test, f )
     }
 }
 
+BOOST_FIXTURE_TEST_CASE( frozen_lookup_test, f )
+{
+    BOOST_TEST_MESSAGE("frozen lookup test using " << NSAMPLES << " samples");
+    srand(1);
+    // cover the domain with a margin on both sides
+    time_t tmin = nt::tzdata_codec::lotime(*tz) - 86400 * 365;
+    time_t tmax = nt::tzdata_codec::hitime(*tz) + 86400 * 365;
+    double coeff = ((double)tmax - tmin) / RAND_MAX;
+    for (int i=0; i<NSAMPLES; ++i)
+        nt::tzdata_codec::check_frozen(*tz,
+            boost::numeric_cast<time_t>(tmin + rand() * coeff));
+    // exact switch points and their neighbours
+    for (time_t t = 1394348400 - 2; t <= 1394348400 + 2; ++t)
+        nt::tzdata_codec::check_frozen(*tz, t);
+    nt::tzdata_codec::check_frozen(*tz, nt::mintime);
+    nt::tzdata_codec::check_frozen(*tz, nt::maxtime);
+}
+
+BOOST_FIXTURE_TEST_CASE( batch_conversion_test, f )
+{
+    BOOST_TEST_MESSAGE("batch conversion test using " << NSAMPLES
+        << " samples");
+    srand(1);
+    time_t tmin = nt::tzdata_codec::lotime(*tz) - 86400 * 365;
+    time_t tmax = nt::tzdata_codec::hitime(*tz) + 86400 * 365;
+    double coeff = ((double)tmax - tmin) / RAND_MAX;
+    std::vector<time_t> in(NSAMPLES), out(NSAMPLES);
+    bool *dst = new bool[NSAMPLES];
+    for (int i=0; i<NSAMPLES; ++i)
+        in[i] = boost::numeric_cast<time_t>(tmin + rand() * coeff);
+    // clustered part: one hour per second around a switch
+    for (int i=0; i<7200; ++i)
+        in[i] = 1394330400 + i;
+
+    for (int sorted=0; sorted<2; ++sorted) {
+        if (sorted)
+            std::sort(in.begin(), in.end());
+
+        tz->to_local(&in[0], &out[0], NSAMPLES, dst);
+        for (int i=0; i<NSAMPLES; ++i) {
+            bool d;
+            BOOST_REQUIRE_EQUAL(out[i], in[i] + tz->offset(in[i], d));
+            BOOST_REQUIRE_EQUAL(dst[i], d);
+        }
+
+        nt::tzdata::shift_point p;
+        tz->to_utc(&in[0], &out[0], NSAMPLES, nt::tzdata::pre_switch, dst);
+        for (int i=0; i<NSAMPLES; ++i) {
+            bool d;
+            tz->offset(in[i], p);
+            BOOST_REQUIRE_EQUAL(out[i], in[i] - p.off1);
+            tz->offset(out[i], d);
+            BOOST_REQUIRE_EQUAL(dst[i], d);
+        }
+        tz->to_utc(&in[0], &out[0], NSAMPLES, nt::tzdata::post_switch, dst);
+        for (int i=0; i<NSAMPLES; ++i) {
+            bool d;
+            tz->offset(in[i], p);
+            BOOST_REQUIRE_EQUAL(out[i], in[i] - p.off2);
+            tz->offset(out[i], d);
+            BOOST_REQUIRE_EQUAL(dst[i], d);
+        }
+    }
+
+    // in place, without dst flags
+    std::vector<time_t> copy(in);
+    tz->to_local(&in[0], &out[0], NSAMPLES);
+    tz->to_local(&copy[0], &copy[0], NSAMPLES);
+    BOOST_REQUIRE(copy == out);
+
+    // 2:30 of 9 March 2014 does not exist, 1:30 of 2 November is repeated
+    time_t gap = nt::to_secs(2014, 3, 9, 2, 30, 0);
+    time_t rep = nt::to_secs(2014, 11, 2, 1, 30, 0);
+    time_t t;
+    BOOST_REQUIRE_THROW(tz->to_utc(&gap, &t, 1, nt::tzdata::strict),
+        std::invalid_argument);
+    BOOST_REQUIRE_THROW(tz->to_utc(&rep, &t, 1, nt::tzdata::strict),
+        std::invalid_argument);
+    tz->to_utc(&rep, &t, 1, nt::tzdata::post_switch, dst);
+    BOOST_REQUIRE_EQUAL(t, 1414909800);
+    BOOST_REQUIRE(!dst[0]);
+    tz->to_utc(&rep, &t, 1, nt::tzdata::pre_switch, dst);
+    BOOST_REQUIRE_EQUAL(t, 1414906200);
+    BOOST_REQUIRE(dst[0]);
+    time_t ok = nt::to_secs(2014, 3, 9, 1, 30, 0);
+    tz->to_utc(&ok, &t, 1, nt::tzdata::strict);
+    BOOST_REQUIRE_EQUAL(t, 1394346600);
+
+    delete[] dst;
+}
+
+BOOST_AUTO_TEST_CASE( civil_test )
+{
+    BOOST_TEST_MESSAGE("civil date test using " << NSAMPLES << " samples");
+    // every day of years -1000 to 3000 round trip
+    long z0 = nt::days_from_civil(-1000, 1, 1);
+    long z1 = nt::days_from_civil(3000, 12, 31);
+    BOOST_REQUIRE_EQUAL(nt::days_from_civil(1970, 1, 1), 0);
+    BOOST_REQUIRE_EQUAL(nt::days_from_civil(2000, 3, 1), 11017);
+    long py = -1001; unsigned pm = 12, pd = 31;
+    for (long z = z0; z <= z1; ++z) {
+        long y; unsigned m, d;
+        nt::civil_from_days(z, y, m, d);
+        BOOST_REQUIRE_EQUAL(nt::days_from_civil(y, m, d), z);
+        // next day of previous date
+        if (d == 1)
+            BOOST_REQUIRE(m == pm % 12 + 1 && y == py + (m == 1));
+        else
+            BOOST_REQUIRE(d == pd + 1 && m == pm && y == py);
+        py = y; pm = m; pd = d;
+    }
+
+    // batch versions
+    const size_t n = 1000;
+    std::vector<long> days(n), days2(n), ys(n);
+    std::vector<unsigned> ms(n), ds(n);
+    for (size_t i = 0; i < n; ++i)
+        days[i] = z0 + (long)(i * 1460981);
+    nt::civil_from_days(&days[0], &ys[0], &ms[0], &ds[0], n);
+    nt::days_from_civil(&ys[0], &ms[0], &ds[0], &days2[0], n);
+    BOOST_REQUIRE(days == days2);
+
+    // broken-down time and time differences against libc
+    srand(1);
+    double coeff = 1e11 / RAND_MAX;
+    std::vector<time_t> ts(NSAMPLES);
+    for (int i=0; i<NSAMPLES; ++i)
+        ts[i] = boost::numeric_cast<time_t>(rand() * coeff - 5e10);
+    ts[0] = 0; ts[1] = -1; ts[2] = 951782400; ts[3] = -86400;
+    std::vector<struct tm> tms(NSAMPLES);
+    nt::utc_tm(&ts[0], &tms[0], NSAMPLES);
+    for (int i=0; i<NSAMPLES; ++i) {
+        struct tm tm;
+        gmtime_r(&ts[i], &tm);
+        BOOST_REQUIRE_EQUAL(tms[i], tm);
+        BOOST_REQUIRE_EQUAL(nt::to_secs(tm.tm_year + 1900, tm.tm_mon + 1,
+            tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec), ts[i]);
+        if (i > 0)
+            BOOST_REQUIRE_EQUAL(nt::tmdiff(tms[i], tms[i - 1]),
+                ts[i] - ts[i - 1]);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE( timestamp_test, f )
+{
+    BOOST_TEST_MESSAGE("timestamp test using " << NSAMPLES << " samples");
+    const nt::ts_layout layouts[] = { nt::ts_compact, nt::ts_iso, nt::ts_sql };
+    const char *formats[] = {
+        "%Y%m%d%H%M%S", "%Y-%m-%dT%H:%M:%S", "%Y-%m-%d %H:%M:%S"
+    };
+    srand(1);
+    time_t tmin = nt::tzdata_codec::lotime(*tz);
+    time_t tmax = nt::tzdata_codec::hitime(*tz);
+    double coeff = ((double)tmax - tmin) / RAND_MAX;
+    for (int i=0; i<NSAMPLES; ++i) {
+        time_t t = boost::numeric_cast<time_t>(tmin + rand() * coeff);
+        int k = i % 3;
+        char s1[32], s2[32];
+        struct tm tm;
+        size_t n = strftime(s1, sizeof(s1), formats[k], localtime_r(&t, &tm));
+        BOOST_REQUIRE_EQUAL(n, nt::ts_length(layouts[k]));
+        nt::format(t, layouts[k], *tz, s2);
+        BOOST_REQUIRE_EQUAL(std::string(s1, n), std::string(s2, n));
+        // times repeated by the switch may be parsed either way
+        if (tm.tm_isdst == 0)
+            BOOST_REQUIRE_EQUAL(nt::parse(s1, layouts[k], *tz,
+                nt::tzdata::post_switch), t);
+        else
+            BOOST_REQUIRE_EQUAL(nt::parse(s1, layouts[k], *tz), t);
+    }
+
+    // fixed size records
+    const char recs[] = "A20140309015959B20140309030000C20141102013000";
+    time_t ts[3];
+    nt::parse(recs + 1, 15, 3, nt::ts_compact, *tz, ts);
+    BOOST_REQUIRE_EQUAL(ts[0], 1394348399);
+    BOOST_REQUIRE_EQUAL(ts[1], 1394348400);
+    BOOST_REQUIRE_EQUAL(ts[2], 1414906200);
+    char out[sizeof(recs)];
+    memcpy(out, recs, sizeof(recs));
+    memset(out + 1, ' ', 14);
+    nt::format(ts, 3, nt::ts_compact, *tz, out + 1, 15);
+    BOOST_REQUIRE_EQUAL(std::string(out), std::string(recs));
+
+    // switch gap and overlap, malformed timestamps
+    BOOST_REQUIRE_THROW(nt::parse("2014-03-09T02:30:00", nt::ts_iso, *tz,
+        nt::tzdata::strict), std::invalid_argument);
+    BOOST_REQUIRE_THROW(nt::parse("2014-11-02 01:30:00", nt::ts_sql, *tz,
+        nt::tzdata::strict), std::invalid_argument);
+    BOOST_REQUIRE_EQUAL(nt::parse("2014-11-02 01:30:00", nt::ts_sql, *tz,
+        nt::tzdata::post_switch), 1414909800);
+    const char *bad[] = {
+        "2014-11-02T01:30:0x", "2014/11/02T01:30:00", "2014-11-02T24:00:00",
+        "2014-02-29T00:00:00", "2014-13-01T00:00:00", "2014-00-10T00:00:00",
+        "2014-11-02T01:60:00", "2014-04-31 00:00:00"
+    };
+    time_t t;
+    BOOST_FOREACH(const char *s, bad)
+        BOOST_REQUIRE(!nt::parse_local(s, nt::ts_iso, t));
+    BOOST_REQUIRE(nt::parse_local("2012-02-29T23:59:59", nt::ts_iso, t));
+    BOOST_REQUIRE_EQUAL(t, 1330559999);
+    BOOST_REQUIRE(!nt::parse_local("2012-02-29T23:59:59", nt::ts_sql, t));
+    BOOST_REQUIRE_THROW(nt::parse("2014110201300/", nt::ts_compact, *tz),
+        std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE( tzfile_test )
+{
+    const char *zones[] = {
+        "America/New_York", "Europe/London", "Europe/Moscow",
+        "Australia/Sydney", "Australia/Lord_Howe", "America/Sao_Paulo",
+        "Asia/Kolkata", "Asia/Tehran", "Pacific/Apia", "UTC"
+    };
+    BOOST_FOREACH(const char *zone, zones) {
+        BOOST_TEST_MESSAGE("comparing tzfile and libc data for " << zone);
+        nt::tzdata tz1(1950, 2100, zone);
+        nt::tzdata tz2(1950, 2100, nt::tzfile(zone));
+        nt::tzdata_codec::compare(tz1, tz2);
+    }
+    BOOST_REQUIRE_THROW(nt::tzfile("No/Such_Zone"), std::runtime_error);
+    BOOST_REQUIRE_THROW(nt::tzfile("TZif", 4), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE( tzregistry_test )
+{
+    const char *zones[] = {
+        "America/New_York", "Europe/London", "Australia/Sydney",
+        "Asia/Kolkata", "Europe/Moscow", "America/Chicago"
+    };
+    const int nzones = sizeof(zones) / sizeof(zones[0]);
+    nt::tzregistry reg(1950, 2100);
+    for (int i=0; i<nzones; ++i)
+        BOOST_REQUIRE_EQUAL(reg.id(zones[i]), (nt::tzregistry::zone_id)i);
+    BOOST_REQUIRE_EQUAL(reg.id(zones[1]), 1u);
+    BOOST_REQUIRE_EQUAL(reg.size(), (nt::tzregistry::zone_id)nzones);
+    BOOST_REQUIRE_EQUAL(reg.name(2), zones[2]);
+
+    // concurrent first use of all zones
+    const nt::tzdata *seen[4][nzones];
+    std::vector<std::thread> threads;
+    for (int k=0; k<4; ++k)
+        threads.push_back(std::thread([&, k]() {
+            for (int i=0; i<nzones; ++i) {
+                int z = (i + k) % nzones;
+                seen[k][z] = &reg.get(z);
+            }
+        }));
+    for (int k=0; k<4; ++k)
+        threads[k].join();
+
+    // one shared instance per zone, same data as built directly
+    for (int i=0; i<nzones; ++i) {
+        for (int k=1; k<4; ++k)
+            BOOST_REQUIRE(seen[k][i] == seen[0][i]);
+        BOOST_REQUIRE(&reg.get(zones[i]) == seen[0][i]);
+        nt::tzdata tz(1950, 2100, nt::tzfile(zones[i]));
+        nt::tzdata_codec::compare(tz, *seen[0][i]);
+    }
+
+    BOOST_REQUIRE_THROW(reg.get(nzones), std::out_of_range);
+    nt::tzregistry::zone_id bad = reg.id("No/Such_Zone");
+    BOOST_REQUIRE_THROW(reg.get(bad), std::runtime_error);
+    BOOST_REQUIRE_THROW(reg.get(bad), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE( switch_index_test )
+{
+    // first switch before 1970, lookups up to maxtime
+    const time_t times[] = { -2000000000, -1000, 1000, 2000000000 };
+    nt::switch_index idx;
+    idx.assign(times, times + 4);
+    BOOST_REQUIRE_EQUAL(idx.upper_bound(nt::mintime), 0u);
+    BOOST_REQUIRE_EQUAL(idx.upper_bound(-1000), 2u);
+    BOOST_REQUIRE_EQUAL(idx.upper_bound(0), 2u);
+    BOOST_REQUIRE_EQUAL(idx.upper_bound(2000000000), 4u);
+    BOOST_REQUIRE_EQUAL(idx.upper_bound(nt::maxtime), 4u);
+}
+
+BOOST_AUTO_TEST_CASE( tzsnapshot_test )
+{
+    const char *zones[] = {
+        "Europe/London", "America/New_York", "UTC", "Australia/Lord_Howe",
+        "Asia/Kolkata"
+    };
+    const int nzones = sizeof(zones) / sizeof(zones[0]);
+    std::vector<nt::tzdata> data;
+    {
+        nt::tzsnapshot_writer out("test-tzsnapshot.bin");
+        for (int i=0; i<nzones; ++i) {
+            data.push_back(nt::tzdata(1950, 2100, nt::tzfile(zones[i])));
+            out.add(zones[i], data.back());
+        }
+        BOOST_REQUIRE_THROW(out.add(zones[0], data[0]),
+            std::invalid_argument);
+        out.commit();
+    }
+
+    nt::tzsnapshot snap("test-tzsnapshot.bin");
+    BOOST_REQUIRE_EQUAL(snap.size(), (size_t)nzones);
+    BOOST_REQUIRE_EQUAL(snap.name(0), "America/New_York");
+    BOOST_REQUIRE(snap.find("No/Such_Zone") == 0);
+    BOOST_REQUIRE_THROW(snap.get(nzones), std::out_of_range);
+
+    srand(1);
+    for (int i=0; i<nzones; ++i) {
+        const nt::tzdata *tz = snap.find(zones[i]);
+        BOOST_REQUIRE(tz);
+        time_t tmin = nt::tzdata_codec::lotime(data[i]) - 86400 * 365;
+        time_t tmax = nt::tzdata_codec::hitime(data[i]) + 86400 * 365;
+        double coeff = ((double)tmax - tmin) / RAND_MAX;
+        for (int k=0; k<NSAMPLES; ++k) {
+            time_t t = boost::numeric_cast<time_t>(tmin + rand() * coeff);
+            nt::tzdata::shift_point p1, p2;
+            data[i].offset(t, p1);
+            tz->offset(t, p2);
+            BOOST_REQUIRE_EQUAL(p1.t0, p2.t0);
+            BOOST_REQUIRE_EQUAL(p1.off1, p2.off1);
+            BOOST_REQUIRE_EQUAL(p1.off2, p2.off2);
+            bool dst1, dst2;
+            BOOST_REQUIRE_EQUAL(data[i].offset(t, dst1), tz->offset(t, dst2));
+            BOOST_REQUIRE_EQUAL(dst1, dst2);
+        }
+    }
+
+    // snapshot data outlive the writer and can be copied
+    nt::tzdata copy(*snap.find("Europe/London"));
+    BOOST_REQUIRE_EQUAL(copy.offset(1394348400), data[0].offset(1394348400));
+
+    // corrupted index content is rejected
+    std::string img;
+    {
+        std::ifstream ifs("test-tzsnapshot.bin", std::ifstream::binary);
+        img.assign(std::istreambuf_iterator<char>(ifs),
+            std::istreambuf_iterator<char>());
+    }
+    typedef nt::detail::tzsnap_zone zone_t;
+    neutx::container::detail::flat_dir_reader<zone_t> dir(img.data(),
+        img.size(), nt::detail::tzsnap_magic, nt::tzsnapshot_writer::abi(),
+        "test");
+    // entry 0 is America/New_York, see above
+    size_t zoff = (const char *)&dir.entry(0) - img.data();
+    zone_t z;
+    memcpy(&z, &img[zoff], sizeof(z));
+    BOOST_REQUIRE(z.lindex.size > 0 && z.lindex.nbuckets > 1);
+    for (int k=0; k<3; ++k) {
+        zone_t bad = z;
+        std::string bimg = img;
+        if (k == 0)
+            bad.lindex.shift = 64;
+        else if (k == 1)
+            bad.uindex.shift = -1;
+        else {
+            // decreasing bucket positions
+            uint32_t b0 = bad.lindex.size;
+            memcpy(&bimg[bad.lindex.buckets], &b0, sizeof(b0));
+        }
+        memcpy(&bimg[zoff], &bad, sizeof(bad));
+        {
+            std::ofstream ofs("test-tzsnapshot-bad.bin",
+                std::ofstream::binary);
+            ofs.write(bimg.data(), bimg.size());
+        }
+        BOOST_REQUIRE_THROW(nt::tzsnapshot("test-tzsnapshot-bad.bin"),
+            std::runtime_error);
+    }
+}
+
 #if defined HAVE_BOOST_CHRONO
+BOOST_FIXTURE_TEST_CASE( tzfile_time_test, f )
+{
+    const char *zone = "America/New_York";
+    time_point tp0 = clock::now();
+    nt::tzdata tz1(1950, 2100, zone);
+    duration d0 = clock::now() - tp0;
+
+    time_point tp1 = clock::now();
+    nt::tzdata tz2(1950, 2100, nt::tzfile(zone));
+    duration d1 = clock::now() - tp1;
+
+    BOOST_TEST_MESSAGE( "libc tzdata load time: "
+        << duration_cast<microseconds>(d0).count() << " us" );
+    BOOST_TEST_MESSAGE( "tzfile tzdata load time: "
+        << duration_cast<microseconds>(d1).count() << " us" );
+}
+
+BOOST_FIXTURE_TEST_CASE( batch_time_test, f )
+{
+    BOOST_TEST_MESSAGE("batch timing test using " << NSAMPLES << " samples");
+    srand(1);
+    time_t tmin = nt::tzdata_codec::lotime(*tz);
+    time_t tmax = nt::tzdata_codec::hitime(*tz);
+    double coeff = ((double)tmax - tmin) / RAND_MAX;
+    std::vector<time_t> rnd(NSAMPLES), seq(NSAMPLES), out(NSAMPLES);
+    for (int i=0; i<NSAMPLES; ++i) {
+        rnd[i] = boost::numeric_cast<time_t>(tmin + rand() * coeff);
+        // one event per second starting a day before a switch
+        seq[i] = 1394262000 + i;
+    }
+
+    time_t s0 = 0, s1 = 0, s2 = 0;
+
+    time_point tp0 = clock::now();
+    for (int i=0; i<NSAMPLES; ++i) s0 += seq[i] + tz->offset(seq[i]);
+    duration d0 = clock::now() - tp0;
+
+    time_point tp1 = clock::now();
+    tz->to_local(&seq[0], &out[0], NSAMPLES);
+    duration d1 = clock::now() - tp1;
+    for (int i=0; i<NSAMPLES; ++i) s1 += out[i];
+
+    time_point tp2 = clock::now();
+    tz->to_local(&rnd[0], &out[0], NSAMPLES);
+    duration d2 = clock::now() - tp2;
+    for (int i=0; i<NSAMPLES; ++i) s2 += out[i] - rnd[i] - tz->offset(rnd[i]);
+
+    BOOST_REQUIRE_EQUAL(s0, s1);
+    BOOST_REQUIRE_EQUAL(s2, 0);
+
+    BOOST_TEST_MESSAGE( "scalar offset() sequential time: "
+        << duration_cast<nanoseconds>(d0 * 1000 / NSAMPLES).count()
+        << " ps" );
+    BOOST_TEST_MESSAGE( "batch to_local() sequential time: "
+        << duration_cast<nanoseconds>(d1 * 1000 / NSAMPLES).count()
+        << " ps" );
+    BOOST_TEST_MESSAGE( "batch to_local() random time: "
+        << duration_cast<nanoseconds>(d2 * 1000 / NSAMPLES).count()
+        << " ps" );
+}
+
+BOOST_AUTO_TEST_CASE( civil_time_test )
+{
+    BOOST_TEST_MESSAGE("civil timing test using " << NSAMPLES << " samples");
+    srand(1);
+    double coeff = 4e9 / RAND_MAX;
+    std::vector<time_t> ts(NSAMPLES);
+    for (int i=0; i<NSAMPLES; ++i)
+        ts[i] = boost::numeric_cast<time_t>(rand() * coeff);
+    std::vector<struct tm> tms(NSAMPLES);
+
+    // sums keep the calls from being optimized out
+    long s0 = 0, s1 = 0;
+
+    time_point tp0 = clock::now();
+    for (int i=0; i<NSAMPLES; ++i) gmtime_r(&ts[i], &tms[i]);
+    duration d0 = (clock::now() - tp0) / NSAMPLES;
+    for (int i=0; i<NSAMPLES; ++i) s0 += tms[i].tm_mday + tms[i].tm_yday;
+
+    time_point tp1 = clock::now();
+    nt::utc_tm(&ts[0], &tms[0], NSAMPLES);
+    duration d1 = (clock::now() - tp1) / NSAMPLES;
+    for (int i=0; i<NSAMPLES; ++i) s1 += tms[i].tm_mday + tms[i].tm_yday;
+
+    BOOST_REQUIRE_EQUAL(s0, s1);
+
+    BOOST_TEST_MESSAGE( "gmtime_r() time: "
+        << duration_cast<nanoseconds>(d0).count() << " ns" );
+    BOOST_TEST_MESSAGE( "utc_tm() time: "
+        << duration_cast<nanoseconds>(d1).count() << " ns" );
+}
+
+BOOST_FIXTURE_TEST_CASE( timestamp_time_test, f )
+{
+    BOOST_TEST_MESSAGE("timestamp timing test using " << NSAMPLES
+        << " samples");
+    srand(1);
+    time_t tmin = nt::tzdata_codec::lotime(*tz);
+    time_t tmax = nt::tzdata_codec::hitime(*tz);
+    double coeff = ((double)tmax - tmin) / RAND_MAX;
+    const size_t len = nt::ts_length(nt::ts_iso);
+    std::vector<time_t> ts(NSAMPLES);
+    std::vector<char> buf(NSAMPLES * len + 1);
+    for (int i=0; i<NSAMPLES; ++i)
+        ts[i] = boost::numeric_cast<time_t>(tmin + rand() * coeff);
+
+    std::vector<time_t> out0(NSAMPLES), out1(NSAMPLES);
+
+    time_point tp0 = clock::now();
+    for (int i=0; i<NSAMPLES; ++i) {
+        struct tm tm;
+        strftime(&buf[i * len], len + 1, "%Y-%m-%dT%H:%M:%S",
+            localtime_r(&ts[i], &tm));
+    }
+    duration d0 = (clock::now() - tp0) / NSAMPLES;
+
+    time_point tp1 = clock::now();
+    for (int i=0; i<NSAMPLES; ++i) {
+        struct tm tm;
+        memset(&tm, 0, sizeof(tm));
+        tm.tm_isdst = -1;
+        strptime(&buf[i * len], "%Y-%m-%dT%H:%M:%S", &tm);
+        out0[i] = mktime(&tm);
+    }
+    duration d1 = (clock::now() - tp1) / NSAMPLES;
+
+    time_point tp2 = clock::now();
+    nt::format(&ts[0], NSAMPLES, nt::ts_iso, *tz, &buf[0], len);
+    duration d2 = (clock::now() - tp2) / NSAMPLES;
+
+    time_point tp3 = clock::now();
+    nt::parse(&buf[0], len, NSAMPLES, nt::ts_iso, *tz, &out1[0]);
+    duration d3 = (clock::now() - tp3) / NSAMPLES;
+
+    // timestamps of the repeated hour may resolve differently
+    for (int i=0; i<NSAMPLES; ++i)
+        BOOST_REQUIRE(out1[i] == out0[i] || out1[i] == out0[i] - 3600);
+
+    BOOST_TEST_MESSAGE( "localtime_r() + strftime() time: "
+        << duration_cast<nanoseconds>(d0).count() << " ns" );
+    BOOST_TEST_MESSAGE( "strptime() + mktime() time: "
+        << duration_cast<nanoseconds>(d1).count() << " ns" );
+    BOOST_TEST_MESSAGE( "format() time: "
+        << duration_cast<nanoseconds>(d2).count() << " ns" );
+    BOOST_TEST_MESSAGE( "parse() time: "
+        << duration_cast<nanoseconds>(d3).count() << " ns" );
+}
+
 BOOST_FIXTURE_TEST_CASE( time_test, f )
 {
     BOOST_TEST_MESSAGE("timing test using " << NSAMPLES << " samples");
@@ -346,14 +912,19 @@ BOOST_FIXTURE_TEST_CASE( time_test, f )
         tms[i] = *tm;
     }
 
+    // sums keep the calls from being optimized out
+    time_t s0 = 0, s1 = 0;
+
     time_point tp0 = clock::now();
-    for (int i=0; i<NSAMPLES; ++i) lc_to_utc(&tms[i]);
+    for (int i=0; i<NSAMPLES; ++i) s0 += lc_to_utc(&tms[i]);
     duration d0 = (clock::now() - tp0) / NSAMPLES;
 
     time_point tp1 = clock::now();
-    for (int i=0; i<NSAMPLES; ++i) timelocal(&tms[i]);
+    for (int i=0; i<NSAMPLES; ++i) s1 += timelocal(&tms[i]);
     duration d1 = (clock::now() - tp1) / NSAMPLES;
 
+    BOOST_REQUIRE_EQUAL(s0, s1);
+
     BOOST_TEST_MESSAGE( "lc_to_utc() time: "
         << duration_cast<nanoseconds>(d0).count() << " ns" );
 